@@ -0,0 +1,128 @@
+#pragma once
+
+// for size_t & ptrdiff_t
+#include <cstddef>
+// for aligned operator new & std::bad_array_new_length
+#include <new>
+// for PTRDIFF_MAX
+#include <cstdint>
+
+
+/**
+ * Used by default to align
+ * allocations to a cache line
+ */
+#define ALIGNED_ALLOCATOR_DEFAULT_ALIGNMENT 64
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Allocator that places every allocation
+     * at an address that is a multiple of Alignment.
+     * Useful for containers that lay out small
+     * groups of elements so that each group
+     * fits into a single cache line.
+     * All instances are interchangable
+     */
+    template <
+        typename T,
+        size_t Alignment = ALIGNED_ALLOCATOR_DEFAULT_ALIGNMENT
+    >
+    struct aligned_allocator {
+        /**
+         * Allows to access template type T
+         */
+        using value_type = T;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using       size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using       pointer =       value_type *;
+        using const_pointer = const value_type *;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using       reference =       value_type &;
+        using const_reference = const value_type &;
+
+        static_assert(
+            Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+            "Alignment must be a power of 2 not less than alignof(T)"
+        );
+
+        /**
+         * Returns the maximum possible count of elements.
+         * Bounded by PTRDIFF_MAX bytes, as no object
+         * may be larger
+         */
+        inline size_type max_size() const {
+            return static_cast<size_type>(PTRDIFF_MAX) / sizeof(T);
+        }
+
+        /**
+         * Returns a pointer to the newly allocated memory.
+         * Throws std::bad_array_new_length if more than
+         * max_size() elements are requested
+         */
+        pointer allocate(size_type size, const_pointer = 0) {
+            if (size > max_size())
+                throw std::bad_array_new_length();
+
+            void * location = ::operator new(size * sizeof(T), std::align_val_t(Alignment));
+            return static_cast<pointer>(location);
+        }
+
+        /**
+         * Deallocates space pointer to by location
+         */
+        void deallocate(pointer location, size_type = 0) {
+            ::operator delete(location, std::align_val_t(Alignment));
+        }
+
+        /**
+         * Does nothing
+         */
+        aligned_allocator() {}
+
+        /**
+         * Allows implicit convertions between
+         * allocators.
+         */
+        template <typename K>
+        aligned_allocator(const aligned_allocator<K, Alignment> &) {}
+
+        /**
+         * Allows to access an allocator of a
+         * different template type:
+         * typename Got::template rebind<New>::other
+         */
+        template <typename K>
+        struct rebind {
+            using other = aligned_allocator<K, Alignment>;
+        };
+
+        /**
+         * Interchangable
+         */
+        bool operator == (const aligned_allocator &) const {
+            return true;
+        }
+
+        /**
+         * Interchangable
+         */
+        bool operator != (const aligned_allocator &) const {
+            return false;
+        }
+    };
+}
@@ -10,9 +10,125 @@
 // for memcpy
 #include <cstring>
 #include <iterator>
+// for std::make_unsigned
+#include <type_traits>
+// for uint32_t, uint64_t
+#include <cstdint>
+// for std::less, std::invoke
+#include <functional>
+// for std::pair
+#include <utility>
+// for std::allocator, std::uninitialized_move
+#include <memory>
+// for std::bad_alloc
+#include <new>
+// for std::move_backward
+#include <algorithm>
+// for std::string_view
+#include <string_view>
+// for std::length_error
+#include <stdexcept>
+// for std::vector<bool>
+#include <vector>
+// for std::numeric_limits
+#include <limits>
+
+#include "../fast_vector/fast_vector.h"
 
-// for heap_sort
-#include "../heap/heap.h"
+
+/**
+ * Size of blocks that merge sorts
+ * insertion sort before merging
+ */
+#define MERGE_SORT_BASE_SIZE 16
+
+/**
+ * Runs shorter than this are extended
+ * by binary insertion in stable_sort
+ */
+#define STABLE_SORT_MIN_RUN 32
+
+/**
+ * Count of wins in a row after which
+ * stable_sort starts galloping
+ */
+#define STABLE_SORT_MIN_GALLOP 7
+
+/**
+ * Ranges shorter than this are
+ * finished by insertion sort
+ */
+#define SORT_INSERTION_THRESHOLD 24
+
+/**
+ * Ranges longer than this take
+ * the pivot as a ninther
+ */
+#define SORT_NINTHER_THRESHOLD 128
+
+/**
+ * Count of moves after which a range
+ * is no longer treated as almost sorted
+ */
+#define SORT_PARTIAL_INSERTION_LIMIT 8
+
+/**
+ * Count of elements classified at once
+ * by the branchless partition
+ */
+#define SORT_BLOCK_SIZE 64
+
+/**
+ * Ranges not longer than this are
+ * insertion sorted by nth_element
+ */
+#define SELECT_INSERTION_THRESHOLD 16
+
+/**
+ * Ranges longer than this take the pivot
+ * from a sample as in Floyd-Rivest
+ */
+#define SELECT_SAMPLE_THRESHOLD 600
+
+/**
+ * nth_element switches to median of medians
+ * pivots once it has partitioned this many
+ * times the size of the range, which keeps
+ * it linear on adversarial inputs
+ */
+#define SELECT_WORK_FACTOR 4
+
+/**
+ * Bits per digit of radix sort for keys
+ * of 32 bits and more. The counts of
+ * a pass should fit into the L1 cache
+ */
+#define RADIX_SORT_DIGIT_BITS 11
+
+/**
+ * Bits per digit of radix sort for
+ * keys of 8 and 16 bits
+ */
+#define RADIX_SORT_SMALL_DIGIT_BITS 8
+
+/**
+ * Ranges not longer than this are
+ * insertion sorted by radix sort
+ */
+#define RADIX_SORT_INSERTION_THRESHOLD 64
+
+/**
+ * Ranges not longer than this are
+ * insertion sorted by string_sort
+ */
+#define STRING_SORT_INSERTION_THRESHOLD 16
+
+/**
+ * Ranges at least this long are distributed
+ * by the first character in place, shorter
+ * ones are split by multikey quick sort
+ */
+#define STRING_SORT_RADIX_THRESHOLD 4096
 
 
 /**
@@ -37,13 +153,25 @@ namespace my {
      * Returns the count of bits that
      * number occupies. Negative numbers
      * will always be claimed to occupy
-     * all bits.
+     * all bits. Uses the count-leading-zeros
+     * instruction where the compiler has it.
      *
-     *   Time Complexity: O(n)
+     *   Time Complexity: O(n), O(1) with the builtin
      * Memory Complexity: O(n), n = sizeof(Number)
      */
     template <typename Number>
     int bit_width(Number x) {
+#if defined(__GNUC__) || defined(__clang__)
+        if constexpr (std::is_integral<Number>::value && sizeof(Number) <= sizeof(unsigned long long)) {
+            using Unsigned = typename std::make_unsigned<Number>::type;
+            auto bits = static_cast<unsigned long long>(static_cast<Unsigned>(x));
+
+            if (bits == 0)
+                return 0;
+
+            return sizeof(unsigned long long) * 8 - __builtin_clzll(bits);
+        }
+#endif
         constexpr int shifting = sizeof(Number) * 8 - 1;
         Number mask = (Number) 1 << shifting;
 
@@ -99,20 +227,62 @@ namespace my {
         return (ac * base + middle) * base + bd;
     }
 
+    /**
+     * Returns its argument, the default
+     * Projection of the algorithms
+     */
+    struct identity {
+        template <typename T>
+        constexpr T && operator () (T && item) const noexcept {
+            return std::forward<T>(item);
+        }
+    };
+
+    /**
+     * Compares the projections of elements.
+     * With the defaults it is just a < b
+     */
+    template <typename Compare, typename Projection>
+    struct projected_compare {
+        Compare compare;
+        Projection projection;
+
+        template <typename First, typename Second>
+        bool operator () (First && first, Second && second) {
+            return std::invoke(
+                compare,
+                std::invoke(projection, std::forward<First>(first)),
+                std::invoke(projection, std::forward<Second>(second))
+            );
+        }
+    };
+
     /**
      * If we accidently meet *middle == value then we should
      * ensure that the near left elements don't == value
      * so we mark middle as right and go further.
+     * The value is compared to projected elements.
      *
      *   Time Complexity: O(log_2(n)), n = distance(left, right)
      * Memory Complexity: O(1)
      */
-    template<class Iterator, class T>
-    Iterator lower_bound(Iterator left, Iterator right, T value) {
+    template <
+        typename Iterator,
+        typename T,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    Iterator lower_bound(
+        Iterator left,
+        Iterator right,
+        const T & value,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
         while (left != right) {
             Iterator middle = left + std::distance(left, right) / 2;
 
-            if (value <= *middle) {
+            if (!std::invoke(compare, std::invoke(projection, *middle), value)) {
                 right = middle;
             } else {
                 left = middle + 1;
@@ -126,16 +296,28 @@ namespace my {
      * If we accidently meet *middle == value then we should
      * ensure that the near right elements don't == value
      * so we mark middle as left and go further.
+     * The value is compared to projected elements.
      *
      *   Time Complexity: O(log_2(n)), n = distance(left, right)
      * Memory Complexity: O(1)
      */
-    template<class Iterator, class T>
-    Iterator upper_bound(Iterator left, Iterator right, T value) {
+    template <
+        typename Iterator,
+        typename T,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    Iterator upper_bound(
+        Iterator left,
+        Iterator right,
+        const T & value,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
         while (left != right) {
             Iterator middle = left + std::distance(left, right) / 2;
 
-            if (value >= *middle) {
+            if (!std::invoke(compare, value, std::invoke(projection, *middle))) {
                 left = middle + 1;
             } else {
                 right = middle;
@@ -174,6 +356,29 @@ namespace my {
     template <typename Iterator>
     using swap_function_for = swap_function<typename std::iterator_traits<Iterator>::value_type>;
 
+    /**
+     * Swaps via std::swap, the default
+     * Swap of the algorithms. Unlike a
+     * function pointer it is always inlined
+     */
+    struct swapper {
+        template <typename T>
+        void operator () (T & first, T & second) const {
+            using std::swap;
+            swap(first, second);
+        }
+    };
+
+    /**
+     * Swaps via my::fast_swap
+     */
+    struct fast_swapper {
+        template <typename T>
+        void operator () (T & first, T & second) const {
+            fast_swap(first, second);
+        }
+    };
+
     /**
      * Swaps all elements
      * of range [first1, last1) and
@@ -182,12 +387,12 @@ namespace my {
      *   Time Complexity: O(n), n = distance(first1, last1)
      * Memory Complexity: O(1)
      */
-    template <typename Iterator>
+    template <typename Iterator, typename Swap = swapper>
     Iterator swap_ranges(
         Iterator first1,
         Iterator last1,
         Iterator first2,
-        swap_function_for<Iterator> swap = std::swap
+        Swap swap = Swap()
     ) {
         while (first1 != last1) {
             swap(*first1, *first2);
@@ -204,12 +409,12 @@ namespace my {
      *   Time Complexity: O(n), n = distance(left, right)
      * Memory Complexity: O(1)
      */
-    template <typename Iterator>
+    template <typename Iterator, typename Swap = swapper>
     Iterator rotate_old(
         Iterator left,
         Iterator start,
         Iterator right,
-        swap_function_for<Iterator> swap = std::swap
+        Swap swap = Swap()
     ) {
         Iterator result = right - std::distance(left, start);
 
@@ -242,16 +447,19 @@ namespace my {
      *   Time Complexity: O(n), n = distance(left, right)
      * Memory Complexity: O(1)
      */
-    template <typename Iterator>
+    template <typename Iterator, typename Swap = swapper>
     Iterator rotate(
         Iterator left,
         Iterator start,
         Iterator right,
-        swap_function_for<Iterator> swap = std::swap
+        Swap swap = Swap()
     ) {
         Iterator result = right - std::distance(left, start);
         Iterator anchor = start;
 
+        if (start == right)
+            return result;
+
         while (left != anchor) {
             swap(*left, *anchor);
             anchor++;
@@ -273,14 +481,24 @@ namespace my {
      *   Time Complexity: O(nn), n = distance(left, right)
      * Memory Complexity: O(1)
      */
-    template <typename Iterator>
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
     void insertion_sort(
         Iterator left,
         Iterator right,
-        swap_function_for<Iterator> swap = std::swap
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
     ) {
+        if (left == right)
+            return;
+
         for (auto it = left + 1; it != right; it++) {
-            auto place = upper_bound(left, it, *it);
+            auto place = upper_bound(left, it, std::invoke(projection, *it), compare, projection);
             rotate(place, it, it + 1, swap);
         }
     }
@@ -291,17 +509,26 @@ namespace my {
      *   Time Complexity: O(nn), n = right - left
      * Memory Complexity: O(1)
      */
-    template <typename Iterator>
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
     void selection_sort(
         Iterator left,
         Iterator right,
-        swap_function_for<Iterator> swap = std::swap
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
     ) {
+        projected_compare<Compare, Projection> less { compare, projection };
+
         for (auto it = left; it < right - 1; it++) {
             auto smallest = it;
 
             for (auto that = it + 1; that != right; that++) {
-                if (*that < *smallest) {
+                if (less(*that, *smallest)) {
                     smallest = that;
                 }
             }
@@ -311,323 +538,2684 @@ namespace my {
     }
 
     /**
-     * Just the merge sort
+     * Merges sorted [left, middle) and [middle, right)
+     * moving the shorter one to the buffer, which
+     * is uninitialized storage for at least that many
+     * elements. Does nothing if the ranges are
+     * already in order. Stable
      *
-     *   Time Complexity: O(nlogn), n = right - left
-     * Memory Complexity: O(n),     n = right - left
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
      */
-    template <typename Iterator>
-    void merge_sort(
+    template <typename Iterator, typename Less>
+    void merge_with_buffer(
         Iterator left,
+        Iterator middle,
         Iterator right,
-        swap_function_for<Iterator> swap = std::swap
+        typename std::iterator_traits<Iterator>::value_type * buffer,
+        Less & less
     ) {
-        size_t size = std::distance(left, right);
-
-        if (size <= 1)
+        if (left == middle || middle == right || !less(*middle, *(middle - 1)))
             return;
 
-        Iterator middle = left + size / 2;
-
-        merge_sort(left, middle);
-        merge_sort(middle, right);
-
-        char temp[size * sizeof(typename std::iterator_traits<Iterator>::value_type)];
+        if (middle - left <= right - middle) {
+            auto end = std::uninitialized_move(left, middle, buffer);
+            auto a = buffer;
+            auto b = middle;
+            auto out = left;
+
+            while (a != end && b != right) {
+                if (less(*b, *a)) {
+                    *out++ = std::move(*b++);
+                } else {
+                    *out++ = std::move(*a++);
+                }
+            }
 
-        Iterator a = left;
-        Iterator b = middle;
-        Iterator c = (Iterator) temp;
-
-        while (a < middle || b < right) {
-            if (a >= middle) {
-                swap(*c, *b);
-                b++;
-                c++;
-            } else if (b >= right) {
-                swap(*c, *a);
-                a++;
-                c++;
-            } else if (*a <= *b) {
-                swap(*c, *a);
-                a++;
-                c++;
-            } else {swap(*c, *b);
-                b++;
-                c++;
+            std::move(a, end, out);
+            std::destroy(buffer, end);
+        } else {
+            auto end = std::uninitialized_move(middle, right, buffer);
+            auto a = middle;
+            auto b = end;
+            auto out = right;
+
+            // equal elements of the right
+            // range must stay on the right
+            while (a != left && b != buffer) {
+                if (less(*(b - 1), *(a - 1))) {
+                    *--out = std::move(*--a);
+                } else {
+                    *--out = std::move(*--b);
+                }
             }
-        }
 
-        my::swap_ranges(left, right, (Iterator) temp, swap);
+            std::move_backward(buffer, b, out);
+            std::destroy(buffer, end);
+        }
     }
 
     /**
-     * Sorts all elements in such way
-     * that every element to the left
-     * of pivot are <= pivot and
-     * every element to the right
-     * are >= than it
+     * Merges sorted [left, middle) and [middle, right)
+     * without a buffer by rotating the half after
+     * the split point of one range with the half
+     * before the split point of the other one. Stable
      *
-     *   Time Complexity: O(n), n = right - left
-     * Memory Complexity: O(1)
+     *   Time Complexity: O(nlogn), n = right - left
+     * Memory Complexity: O(logn)
      */
-    template <typename Iterator>
-    Iterator partition(
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void merge_in_place(
         Iterator left,
+        Iterator middle,
         Iterator right,
-        Iterator pivot,
-        swap_function_for<Iterator> swap = std::swap
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
     ) {
-        if (pivot != right - 1) {
-            swap(*(pivot), *(right - 1));
-            pivot = right - 1;
-        }
+        projected_compare<Compare, Projection> less { compare, projection };
 
-        Iterator a = left;
-        Iterator b = right - 2;
+        while (left != middle && middle != right && less(*middle, *(middle - 1))) {
+            if (right - left == 2) {
+                swap(*left, *middle);
+                return;
+            }
 
-        while (a < b) {
-            if (*a <= *pivot) {
-                a++;
-            } else if (*b > *pivot) {
-                b--;
+            Iterator first_cut;
+            Iterator second_cut;
+
+            if (middle - left >= right - middle) {
+                first_cut = left + (middle - left) / 2;
+                second_cut = lower_bound(middle, right, std::invoke(projection, *first_cut), compare, projection);
             } else {
-                swap(*a, *b);
+                second_cut = middle + (right - middle) / 2;
+                first_cut = upper_bound(left, middle, std::invoke(projection, *second_cut), compare, projection);
             }
-        }
 
-        // exceptional case where pivot
-        // is the greatest item and we
-        // shouldn't swap it with anything
-        if (*b >= *pivot)
-            swap(*b, *pivot);
+            Iterator new_middle = rotate(first_cut, middle, second_cut, swap);
 
-        return b;
+            // recurse into the shorter part
+            if (new_middle - left < right - new_middle) {
+                merge_in_place(left, first_cut, new_middle, compare, projection, swap);
+                left = new_middle;
+                middle = second_cut;
+            } else {
+                merge_in_place(new_middle, second_cut, right, compare, projection, swap);
+                right = new_middle;
+                middle = first_cut;
+            }
+        }
     }
 
     /**
-     * Just the quick sort
+     * Merge sort that needs no buffer:
+     * merges bottom-up with merge_in_place.
+     * For when memory is tight
      *
-     *   Time Complexity: O(nlogn), n = right - left
-     * Memory Complexity: O(1)
+     *   Time Complexity: O(nlognlogn), n = right - left
+     * Memory Complexity: O(logn)
      */
-    template <typename Iterator>
-    void quick_sort(
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void merge_sort_in_place(
         Iterator left,
         Iterator right,
-        swap_function_for<Iterator> swap = std::swap
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
     ) {
         size_t size = std::distance(left, right);
 
-        if (size <= 1)
-            return;
-
-        Iterator middle = left + size / 2;
-
-        if (*middle < *left) {
-            swap(*left, *middle);
-        }
-
-        if (*(right - 1) < *left) {
-            swap(*left, *(right - 1));
+        for (size_t it = 0; it < size; it += MERGE_SORT_BASE_SIZE) {
+            size_t end = it + MERGE_SORT_BASE_SIZE < size ? it + MERGE_SORT_BASE_SIZE : size;
+            insertion_sort(left + it, left + end, compare, projection, swap);
         }
 
-        if (*middle < *(right - 1)) {
-            swap(*middle, *(right - 1));
+        for (size_t width = MERGE_SORT_BASE_SIZE; width < size; width *= 2) {
+            for (size_t it = 0; it + width < size; it += 2 * width) {
+                size_t end = it + 2 * width < size ? it + 2 * width : size;
+                merge_in_place(left + it, left + it + width, left + end, compare, projection, swap);
+            }
         }
-
-        auto separator = partition(left, right, right - 1, swap);
-        quick_sort(left, separator, swap);
-        quick_sort(separator + 1, right, swap);
     }
 
     /**
-     * Returns an element that would be located
-     * at a specific position if the container
-     * was sorted
+     * Merge sort over a caller-provided buffer,
+     * which must be uninitialized storage for at
+     * least (n + 1) / 2 elements. Insertion sorts
+     * small blocks, then merges bottom-up. Swap is
+     * only used by the insertion sort
      *
-     *   Time Complexity: O(n), n = right - left
+     *   Time Complexity: O(nlogn), n = right - left
      * Memory Complexity: O(1)
      */
-    template <typename Iterator>
-    Iterator select(
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void merge_sort_buffered(
         Iterator left,
         Iterator right,
-        size_t index,
-        swap_function_for<Iterator> swap = std::swap
+        typename std::iterator_traits<Iterator>::value_type * buffer,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
     ) {
-        constexpr size_t type_size = sizeof(typename std::iterator_traits<Iterator>::value_type);
         size_t size = std::distance(left, right);
+        projected_compare<Compare, Projection> less { compare, projection };
 
-        if (size <= 1)
-            return left;
-
-        // array of medians of portions of 5 items
-        size_t sub_size = ceil(size / 5);
-        char temp[type_size * sub_size];
-
-        Iterator sub_begin = left;
-        Iterator sub_end = left + 5;
-        Iterator sub = (Iterator) temp;
-
-        // fill all but the last portion (<= 5)
-        while (sub_begin < right - 5) {
-            quick_sort(sub_begin, sub_end, swap);
-            Iterator sub_median = sub_begin + std::distance(sub_begin, sub_end) / 2;
-            std::memcpy(sub, sub_median, type_size);
-            sub_begin += 5;
-            sub_end += 5;
-            sub++;
+        for (size_t it = 0; it < size; it += MERGE_SORT_BASE_SIZE) {
+            size_t end = it + MERGE_SORT_BASE_SIZE < size ? it + MERGE_SORT_BASE_SIZE : size;
+            insertion_sort(left + it, left + end, compare, projection, swap);
         }
 
-        // process the last portion
-        quick_sort(sub_begin, right, swap);
-        Iterator sub_median = sub_begin + std::distance(sub_begin, right) / 2;
-        std::memcpy(sub, sub_median, type_size);
-
-        // median of medians
-        Iterator temp_median = select((Iterator) temp, (Iterator) temp + sub_size, size / 2, swap);
-        // find median element in the source container
-        Iterator median = lower_bound(left, right, *temp_median);
-
-        Iterator separator = partition(left, right, median, swap);
-        size_t separator_index = separator - left;
-
-        if (separator_index == index)
-            return separator;
-
-        if (separator_index < index)
-            return select(separator + 1, right, index - separator_index - 1);
-
-        return select(left, separator, index);
+        for (size_t width = MERGE_SORT_BASE_SIZE; width < size; width *= 2) {
+            for (size_t it = 0; it + width < size; it += 2 * width) {
+                size_t end = it + 2 * width < size ? it + 2 * width : size;
+                merge_with_buffer(left + it, left + it + width, left + end, buffer, less);
+            }
+        }
     }
 
     /**
-     * Just the heap sort
+     * Just the merge sort. Stable. Allocates a single
+     * buffer of n / 2 elements and falls back to
+     * merge_sort_in_place if that fails
      *
      *   Time Complexity: O(nlogn), n = right - left
-     * Memory Complexity: O(n)
+     * Memory Complexity: O(n),     n = right - left
      */
-    template <typename Iterator>
-    void heap_sort(
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void merge_sort(
         Iterator left,
         Iterator right,
-        swap_function_for<Iterator> swap = std::swap
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
     ) {
         using T = typename std::iterator_traits<Iterator>::value_type;
-        my::heap<T> heap(left, right, my::greater);
 
-        while (left != right)  {
-            swap(*left, *heap.begin());
-            heap.pop_top();
-            left++;
+        size_t size = std::distance(left, right);
+
+        if (size <= MERGE_SORT_BASE_SIZE) {
+            insertion_sort(left, right, compare, projection, swap);
+            return;
+        }
+
+        std::allocator<T> allocator;
+        T * buffer;
+
+        try {
+            buffer = allocator.allocate((size + 1) / 2);
+        } catch (const std::bad_alloc &) {
+            merge_sort_in_place(left, right, compare, projection, swap);
+            return;
+        }
+
+        try {
+            merge_sort_buffered(left, right, buffer, compare, projection, swap);
+        } catch (...) {
+            allocator.deallocate(buffer, (size + 1) / 2);
+            throw;
         }
+
+        allocator.deallocate(buffer, (size + 1) / 2);
     }
 
     /**
-     * Just the counting sort
+     * Returns the first position in [first, last)
+     * whose element is greater than key, probing
+     * 1, 3, 7, ... elements from first before the
+     * binary search. Cheap if the answer is near first
      *
-     *   Time Complexity: O(n), n = right - left
-     * Memory Complexity: O(k), k = limit
+     *   Time Complexity: O(logk), k = answer - first
+     * Memory Complexity: O(1)
      */
-    template <typename Iterator, typename Number>
-    void counting_sort(
-        Iterator left,
-        Iterator right,
-        Number limit,
-        swap_function_for<Iterator> swap = std::swap
-    ) {
-        using T = typename std::iterator_traits<Iterator>::value_type;
+    template <typename Iterator, typename T, typename Less>
+    Iterator gallop_upper(Iterator first, Iterator last, const T & key, Less & less) {
+        size_t size = last - first;
+        size_t low = 0;
+        size_t high = 1;
+
+        while (high <= size && !less(key, first[high - 1])) {
+            low = high;
+            high = 2 * high + 1;
+        }
 
-        static_assert(
-            std::is_same<T, Number>::value,
-            "T must be a Number"
-        );
+        high = high < size ? high : size;
+
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+
+            if (less(key, first[middle])) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
 
-        T counts[limit];
+        return first + low;
+    }
 
-        for (auto it = 0; it < limit; it++) {
-            counts[it] = 0;
+    /**
+     * Returns the first position in [first, last)
+     * whose element is not less than key, probing
+     * from first like gallop_upper
+     *
+     *   Time Complexity: O(logk), k = answer - first
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename T, typename Less>
+    Iterator gallop_lower(Iterator first, Iterator last, const T & key, Less & less) {
+        size_t size = last - first;
+        size_t low = 0;
+        size_t high = 1;
+
+        while (high <= size && less(first[high - 1], key)) {
+            low = high;
+            high = 2 * high + 1;
         }
 
-        for (auto it = left; it != right; it++) {
-            counts[*it]++;
+        high = high < size ? high : size;
+
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+
+            if (less(first[middle], key)) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
         }
 
-        for (auto it = 1; it < limit; it++) {
-            counts[it] += counts[it - 1];
+        return first + low;
+    }
+
+    /**
+     * Same as gallop_upper but probes
+     * 1, 3, 7, ... elements before last
+     *
+     *   Time Complexity: O(logk), k = last - answer
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename T, typename Less>
+    Iterator gallop_upper_backward(Iterator first, Iterator last, const T & key, Less & less) {
+        size_t size = last - first;
+        size_t low = 0;
+        size_t high = 1;
+
+        // counts elements from the back
+        while (high <= size && less(key, *(last - high))) {
+            low = high;
+            high = 2 * high + 1;
         }
 
-        T sorted[std::distance(left, right)];
+        high = high < size ? high : size;
+        return gallop_upper(last - high, last - low, key, less);
+    }
 
-        for (auto it = right - 1; it != left - 1; it--) {
-            counts[*it] -= 1;
-            swap(sorted[counts[*it]], *it);
+    /**
+     * Same as gallop_lower but probes
+     * 1, 3, 7, ... elements before last
+     *
+     *   Time Complexity: O(logk), k = last - answer
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename T, typename Less>
+    Iterator gallop_lower_backward(Iterator first, Iterator last, const T & key, Less & less) {
+        size_t size = last - first;
+        size_t low = 0;
+        size_t high = 1;
+
+        while (high <= size && !less(*(last - high), key)) {
+            low = high;
+            high = 2 * high + 1;
         }
 
-        std::swap_ranges(left, right, sorted);
+        high = high < size ? high : size;
+        return gallop_lower(last - high, last - low, key, less);
     }
 
     /**
-     * Just the radix sort
+     * Merges [left, middle) and [middle, right)
+     * of a stable_sort. Moves the shorter one to
+     * the buffer and merges one element at a time
+     * until one side wins min_gallop times in a row,
+     * then switches to moving whole galloped
+     * blocks while that keeps paying off.
+     * Uses merge_in_place if there's no buffer
      *
-     *   Time Complexity: O(k), k = limit
-     * Memory Complexity: O(n + k), n = right - left
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
      */
-    template <typename Iterator, typename Number>
-    void radix_sort(
+    template <typename Iterator, typename Compare, typename Projection, typename Swap>
+    void merge_galloping(
         Iterator left,
+        Iterator middle,
         Iterator right,
-        Number limit,
-        swap_function_for<Iterator> swap = std::swap
+        typename std::iterator_traits<Iterator>::value_type * buffer,
+        size_t & shared_gallop,
+        Compare & compare,
+        Projection & projection,
+        Swap & swap
     ) {
-        // 2^n digits
-        constexpr auto DIGIT_BASE = 64;
-        constexpr auto POWER = 6;
-        constexpr auto MASK = DIGIT_BASE - 1;
+        projected_compare<Compare &, Projection &> less { compare, projection };
 
-        using T = typename std::iterator_traits<Iterator>::value_type;
+        // a local copy stays in a register, stores
+        // to out may alias the reference otherwise
+        size_t min_gallop = shared_gallop;
 
-        static_assert(
-            std::is_same<T, Number>::value,
-            "T must be a Number"
-        );
+        // the elements that are already in place
+        left = gallop_upper(left, middle, *middle, less);
+
+        if (left == middle)
+            return;
 
-        auto length = std::distance(left, right);
+        right = gallop_lower_backward(middle, right, *(middle - 1), less);
 
-        T trimmed[length];
-        std::copy(left, right, trimmed);
+        if (middle == right)
+            return;
+
+        if (buffer == nullptr) {
+            merge_in_place(left, middle, right, compare, projection, swap);
+            return;
+        }
 
-        T counts[DIGIT_BASE];
+        if (middle - left <= right - middle) {
+            auto end = std::uninitialized_move(left, middle, buffer);
+            auto a = buffer;
+            auto b = middle;
+            auto out = left;
+
+            while (a != end && b != right) {
+                size_t streak = 0;
+                bool last = false;
+
+                // the selection compiles to a conditional
+                // move instead of a branch that random
+                // input would mispredict half the time
+                while (true) {
+                    bool take_b = less(*b, *a);
+                    auto * source = take_b ? std::addressof(*b) : std::addressof(*a);
+
+                    *out++ = std::move(*source);
+                    b += take_b;
+                    a += !take_b;
+                    streak = (take_b == last) * streak + 1;
+                    last = take_b;
+
+                    if (a == end || b == right || streak >= min_gallop)
+                        break;
+                }
 
-        T trimmed_sorted[length];
-        T    left_sorted[length];
+                while (a != end && b != right) {
+                    auto stop_a = gallop_upper(a, end, *b, less);
+                    size_t count_a = stop_a - a;
+                    out = std::move(a, stop_a, out);
+                    a = stop_a;
 
-        for (auto digit = 0; digit < limit; digit++) {
-            for (auto it = 0; it < DIGIT_BASE; it++) {
-                counts[it] = 0;
-            }
+                    if (a == end)
+                        break;
 
-            for (auto it = 0; it < length; it++) {
-                counts[trimmed[it] & MASK]++;
-            }
+                    auto stop_b = gallop_lower(b, right, *a, less);
+                    size_t count_b = stop_b - b;
+                    out = std::move(b, stop_b, out);
+                    b = stop_b;
+
+                    if (count_a < STABLE_SORT_MIN_GALLOP && count_b < STABLE_SORT_MIN_GALLOP) {
+                        min_gallop++;
+                        break;
+                    }
 
-            for (auto it = 1; it < DIGIT_BASE; it++) {
-                counts[it] += counts[it - 1];
+                    min_gallop -= min_gallop > 1;
+                }
             }
 
-            for (auto it = length - 1; it >= 0; it--) {
-                counts[trimmed[it] & MASK] -= 1;
+            std::move(a, end, out);
+            std::destroy(buffer, end);
+        } else {
+            auto end = std::uninitialized_move(middle, right, buffer);
+            auto a = middle;
+            auto b = end;
+            auto out = right;
+
+            while (a != left && b != buffer) {
+                size_t streak = 0;
+                bool last = false;
+
+                while (true) {
+                    bool take_a = less(*(b - 1), *(a - 1));
+                    auto * source = take_a ? std::addressof(*(a - 1)) : std::addressof(*(b - 1));
+
+                    *--out = std::move(*source);
+                    a -= take_a;
+                    b -= !take_a;
+                    streak = (take_a == last) * streak + 1;
+                    last = take_a;
+
+                    if (a == left || b == buffer || streak >= min_gallop)
+                        break;
+                }
+
+                while (a != left && b != buffer) {
+                    auto stop_a = gallop_upper_backward(left, a, *(b - 1), less);
+                    size_t count_a = a - stop_a;
+                    out = std::move_backward(stop_a, a, out);
+                    a = stop_a;
+
+                    if (a == left)
+                        break;
 
-                trimmed_sorted[counts[trimmed[it] & MASK]] = trimmed[it];
-                   left_sorted[counts[trimmed[it] & MASK]] = left[it];
+                    auto stop_b = gallop_lower_backward(buffer, b, *(a - 1), less);
+                    size_t count_b = b - stop_b;
+                    out = std::move_backward(stop_b, b, out);
+                    b = stop_b;
+
+                    if (count_a < STABLE_SORT_MIN_GALLOP && count_b < STABLE_SORT_MIN_GALLOP) {
+                        min_gallop++;
+                        break;
+                    }
+
+                    min_gallop -= min_gallop > 1;
+                }
             }
 
-            std::copy(trimmed_sorted, trimmed_sorted + length, trimmed);
-            std::copy(   left_sorted,    left_sorted + length, left);
+            std::move_backward(buffer, b, out);
+            std::destroy(buffer, end);
+        }
+
+        shared_gallop = min_gallop;
+    }
 
-            for (auto it = 0; it < length; it++) {
-                trimmed[it] >>= POWER;
+    /**
+     * Returns the Powersort priority of the boundary
+     * between runs [start, start + first) and
+     * [start + first, start + first + second) of n
+     * elements: the depth of the node of the perfectly
+     * balanced merge tree that the boundary falls into
+     *
+     *   Time Complexity: O(logn)
+     * Memory Complexity: O(1)
+     */
+    inline int powersort_power(size_t start, size_t first, size_t second, size_t size) {
+        // twice the midpoints of the runs
+        // to stay in integers
+        size_t a = 2 * start + first;
+        size_t b = a + first + second;
+        int power = 0;
+
+        while (true) {
+            power++;
+
+            if (a >= size) {
+                a -= size;
+                b -= size;
+            } else if (b >= size) {
+                break;
             }
+
+            a <<= 1;
+            b <<= 1;
+        }
+
+        return power;
+    }
+
+    /**
+     * Stable sort that adapts to existing order.
+     * Finds non-descending and strictly descending
+     * (reversed in place) runs, extends the short
+     * ones to STABLE_SORT_MIN_RUN with binary insertion
+     * and merges them in the order given by Powersort
+     * with galloping merges. Allocates n / 2 elements
+     * on the first merge and merges in place if that
+     * fails
+     *
+     *   Time Complexity: O(nlogn), O(n) for presorted input
+     * Memory Complexity: O(n),     n = right - left
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void stable_sort(
+        Iterator left,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        size_t size = std::distance(left, right);
+
+        if (size <= 1)
+            return;
+
+        projected_compare<Compare &, Projection &> less { compare, projection };
+
+        struct pending_run {
+            size_t start;
+            size_t length;
+            int power;
+        };
+
+        // powers on the stack strictly increase
+        // and never exceed the bit count of n
+        pending_run runs[sizeof(size_t) * 8 + 2];
+        size_t count = 0;
+
+        std::allocator<T> allocator;
+        T * buffer = nullptr;
+        bool allocated = false;
+        size_t min_gallop = STABLE_SORT_MIN_GALLOP;
+
+        auto merge_top = [&]() {
+            auto & first = runs[count - 2];
+            auto & second = runs[count - 1];
+
+            if (!allocated) {
+                allocated = true;
+
+                try {
+                    buffer = allocator.allocate(size / 2);
+                } catch (const std::bad_alloc &) {
+                    buffer = nullptr;
+                }
+            }
+
+            merge_galloping(
+                left + first.start,
+                left + second.start,
+                left + second.start + second.length,
+                buffer, min_gallop, compare, projection, swap
+            );
+
+            first.length += second.length;
+            count--;
+        };
+
+        try {
+            for (size_t start = 0; start < size; ) {
+                size_t end = start + 1;
+
+                if (end < size && less(left[end], left[end - 1])) {
+                    end++;
+
+                    while (end < size && less(left[end], left[end - 1])) {
+                        end++;
+                    }
+
+                    for (size_t low = start, high = end - 1; low < high; low++, high--) {
+                        swap(left[low], left[high]);
+                    }
+                } else if (end < size) {
+                    end++;
+
+                    while (end < size && !less(left[end], left[end - 1])) {
+                        end++;
+                    }
+                }
+
+                size_t extended = start + STABLE_SORT_MIN_RUN < size ? start + STABLE_SORT_MIN_RUN : size;
+
+                for (; end < extended; end++) {
+                    auto place = upper_bound(left + start, left + end, std::invoke(projection, left[end]), compare, projection);
+
+                    // a hole costs one move per shifted
+                    // element, a rotation three
+                    if constexpr (std::is_same<Swap, swapper>::value) {
+                        if (place != left + end) {
+                            T item = std::move(left[end]);
+                            std::move_backward(place, left + end, left + end + 1);
+                            *place = std::move(item);
+                        }
+                    } else {
+                        rotate(place, left + end, left + end + 1, swap);
+                    }
+                }
+
+                if (count > 0) {
+                    int power = powersort_power(runs[count - 1].start, runs[count - 1].length, end - start, size);
+
+                    while (count > 1 && runs[count - 2].power > power) {
+                        merge_top();
+                    }
+
+                    runs[count - 1].power = power;
+                }
+
+                runs[count++] = { start, end - start, 0 };
+                start = end;
+            }
+
+            while (count > 1) {
+                merge_top();
+            }
+        } catch (...) {
+            if (buffer != nullptr) {
+                allocator.deallocate(buffer, size / 2);
+            }
+
+            throw;
+        }
+
+        if (buffer != nullptr) {
+            allocator.deallocate(buffer, size / 2);
+        }
+    }
+
+    /**
+     * Sorts all elements in such way
+     * that every element to the left
+     * of pivot are <= pivot and
+     * every element to the right
+     * are >= than it
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    Iterator partition(
+        Iterator left,
+        Iterator right,
+        Iterator pivot,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        projected_compare<Compare, Projection> less { compare, projection };
+
+        if (pivot != right - 1) {
+            swap(*(pivot), *(right - 1));
+            pivot = right - 1;
+        }
+
+        Iterator a = left;
+        Iterator b = right - 2;
+
+        while (a < b) {
+            if (!less(*pivot, *a)) {
+                a++;
+            } else if (less(*pivot, *b)) {
+                b--;
+            } else {
+                swap(*a, *b);
+            }
+        }
+
+        // a and b met at an element that
+        // hasn't been compared yet. If it is
+        // less than the pivot, the pivot goes
+        // right after it (possibly staying
+        // in place if it is the greatest item)
+        if (less(*b, *pivot))
+            b++;
+
+        if (b != pivot)
+            swap(*b, *pivot);
+
+        return b;
+    }
+
+    /**
+     * Moves the elements of [first, last) for which
+     * goes_left(element) is true before the others.
+     * Returns the border. BlockQuicksort: goes_left is
+     * evaluated for blocks of SORT_BLOCK_SIZE elements
+     * at both ends, and the offsets of the misplaced
+     * ones are recorded without branching on the
+     * results. The misplaced elements are then
+     * exchanged by a single cycle of moves,
+     * not by a swap per pair
+     *
+     *   Time Complexity: O(n), n = last - first
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Predicate>
+    Iterator partition_blocks(Iterator first, Iterator last, Predicate & goes_left) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        alignas(64) unsigned char offsets_left[SORT_BLOCK_SIZE];
+        alignas(64) unsigned char offsets_right[SORT_BLOCK_SIZE];
+
+        Iterator base_left = first;
+        Iterator base_right = last;
+        size_t count_left = 0, count_right = 0;
+        size_t start_left = 0, start_right = 0;
+
+        while (first < last) {
+            // refill the empty blocks, splitting
+            // the unknown part if both are empty
+            size_t unknown = last - first;
+            size_t split_left = count_left == 0 ? (count_right == 0 ? unknown / 2 : unknown) : 0;
+            size_t split_right = count_right == 0 ? unknown - split_left : 0;
+
+            split_left = split_left < SORT_BLOCK_SIZE ? split_left : SORT_BLOCK_SIZE;
+            split_right = split_right < SORT_BLOCK_SIZE ? split_right : SORT_BLOCK_SIZE;
+
+            for (size_t it = 0; it < split_left; it++) {
+                offsets_left[count_left] = static_cast<unsigned char>(it);
+                count_left += !goes_left(*first);
+                first++;
+            }
+
+            for (size_t it = 0; it < split_right; it++) {
+                offsets_right[count_right] = static_cast<unsigned char>(it + 1);
+                count_right += goes_left(*--last);
+            }
+
+            size_t count = count_left < count_right ? count_left : count_right;
+
+            if (count > 0) {
+                Iterator from = base_left + offsets_left[start_left];
+                Iterator to = base_right - offsets_right[start_right];
+                T item = std::move(*from);
+                *from = std::move(*to);
+
+                for (size_t it = 1; it < count; it++) {
+                    from = base_left + offsets_left[start_left + it];
+                    *to = std::move(*from);
+                    to = base_right - offsets_right[start_right + it];
+                    *from = std::move(*to);
+                }
+
+                *to = std::move(item);
+            }
+
+            count_left -= count;
+            count_right -= count;
+            start_left += count;
+            start_right += count;
+
+            if (count_left == 0) {
+                start_left = 0;
+                base_left = first;
+            }
+
+            if (count_right == 0) {
+                start_right = 0;
+                base_right = last;
+            }
+        }
+
+        // one of the blocks may still have
+        // misplaced elements, move them to
+        // the border
+        while (count_left > 0) {
+            count_left--;
+            std::iter_swap(base_left + offsets_left[start_left + count_left], --last);
+            first = last;
+        }
+
+        while (count_right > 0) {
+            count_right--;
+            std::iter_swap(base_right - offsets_right[start_right + count_right], first);
+            first++;
+            last = first;
+        }
+
+        return first;
+    }
+
+    /**
+     * Partitions around *left by partition_blocks.
+     * Elements equal to the pivot go to the right.
+     * Returns the final pivot position
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Less>
+    Iterator block_partition(Iterator left, Iterator right, Less & less) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        T pivot = std::move(*left);
+
+        auto goes_left = [&](auto & item) {
+            return less(item, pivot);
+        };
+
+        Iterator place = partition_blocks(left + 1, right, goes_left) - 1;
+
+        if (place != left) {
+            *left = std::move(*place);
+        }
+
+        *place = std::move(pivot);
+        return place;
+    }
+
+    /**
+     * Partitions around *left into the elements
+     * less than the pivot, the equal ones and the
+     * greater ones. Returns the range of the equal
+     * ones. The second pass only goes over the
+     * elements not less than the pivot
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Less>
+    std::pair<Iterator, Iterator> block_partition3(Iterator left, Iterator right, Less & less) {
+        Iterator place = block_partition(left, right, less);
+
+        auto goes_left = [&](auto & item) {
+            return !less(*place, item);
+        };
+
+        return { place, partition_blocks(place + 1, right, goes_left) };
+    }
+
+    /**
+     * Same as my::partition but without
+     * branching on the comparisons, which pays
+     * off for cheap ones on unpredictable data.
+     * Elements equal to the pivot go to the
+     * right. Moves elements rather than
+     * swapping them
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    Iterator partition_branchless(
+        Iterator left,
+        Iterator right,
+        Iterator pivot,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
+        projected_compare<Compare, Projection> less { compare, projection };
+
+        std::iter_swap(left, pivot);
+        return block_partition(left, right, less);
+    }
+
+    /**
+     * Three-way partition: the elements less
+     * than the pivot go first, then the equal
+     * ones, then the greater ones. Returns the
+     * range of the equal ones, so that callers
+     * skip all of them at once and ranges with
+     * few distinct keys do not degrade. Moves
+     * elements rather than swapping them
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    std::pair<Iterator, Iterator> partition3(
+        Iterator left,
+        Iterator right,
+        Iterator pivot,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
+        projected_compare<Compare, Projection> less { compare, projection };
+
+        std::iter_swap(left, pivot);
+        return block_partition3(left, right, less);
+    }
+
+    /**
+     * Just the quick sort
+     *
+     *   Time Complexity: O(nlogn), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void quick_sort(
+        Iterator left,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        size_t size = std::distance(left, right);
+
+        if (size <= 1)
+            return;
+
+        Iterator middle = left + size / 2;
+        projected_compare<Compare, Projection> less { compare, projection };
+
+        if (less(*middle, *left)) {
+            swap(*left, *middle);
+        }
+
+        if (less(*(right - 1), *left)) {
+            swap(*left, *(right - 1));
+        }
+
+        if (less(*middle, *(right - 1))) {
+            swap(*middle, *(right - 1));
+        }
+
+        // the equal elements are done at once
+        // unless swap has to be called
+        if constexpr (std::is_same<Swap, swapper>::value) {
+            auto equal = partition3(left, right, right - 1, compare, projection);
+            quick_sort(left, equal.first, compare, projection, swap);
+            quick_sort(equal.second, right, compare, projection, swap);
+        } else {
+            auto separator = partition(left, right, right - 1, compare, projection, swap);
+            quick_sort(left, separator, compare, projection, swap);
+            quick_sort(separator + 1, right, compare, projection, swap);
+        }
+    }
+
+    /**
+     * Restores the max-heap property of
+     * [left, left + size) below the root
+     * whose element has just been replaced.
+     * Floyd's variant: the hole is first sunk
+     * to a leaf along the greater children
+     * without looking at the new element,
+     * then the element climbs back up. It
+     * usually ends near the bottom, so this
+     * needs about log_2(n) comparisons
+     * instead of 2 log_2(n).
+     *
+     *   Time Complexity: O(log_2(n)), n = size
+     * Memory Complexity: O(1)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void sift_down_to_leaf(
+        Iterator left,
+        size_t root,
+        size_t size,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        projected_compare<Compare, Projection> less { compare, projection };
+        size_t it = root;
+
+        while (2 * it + 2 < size) {
+            size_t child = 2 * it + 1;
+
+            if (less(left[child], left[child + 1])) {
+                child++;
+            }
+
+            swap(left[it], left[child]);
+            it = child;
+        }
+
+        if (2 * it + 1 < size) {
+            swap(left[it], left[2 * it + 1]);
+            it = 2 * it + 1;
+        }
+
+        while (it > root && less(left[(it - 1) / 2], left[it])) {
+            swap(left[(it - 1) / 2], left[it]);
+            it = (it - 1) / 2;
+        }
+    }
+
+    /**
+     * Just the heap sort. Builds a max-heap
+     * in place bottom-up, then repeatedly swaps
+     * the top to the end of the shrinking heap.
+     * Does not allocate
+     *
+     *   Time Complexity: O(nlogn), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void heap_sort(
+        Iterator left,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        size_t size = std::distance(left, right);
+
+        if (size <= 1)
+            return;
+
+        for (size_t it = size / 2; it > 0; it--) {
+            sift_down_to_leaf(left, it - 1, size, compare, projection, swap);
+        }
+
+        for (size_t it = size - 1; it > 0; it--) {
+            swap(left[0], left[it]);
+            sift_down_to_leaf(left, 0, it, compare, projection, swap);
+        }
+    }
+
+    /**
+     * Insertion sort by moves for my::sort.
+     * If unguarded, an element not greater than
+     * any of the range must precede left
+     *
+     *   Time Complexity: O(nn), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <bool Unguarded, typename Iterator, typename Compare>
+    void sort_insertion(Iterator left, Iterator right, Compare & compare) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        if (left == right)
+            return;
+
+        for (auto it = left + 1; it != right; it++) {
+            if (!compare(*it, *(it - 1)))
+                continue;
+
+            T item = std::move(*it);
+            Iterator hole = it;
+
+            do {
+                *hole = std::move(*(hole - 1));
+                hole--;
+            } while ((Unguarded || hole != left) && compare(item, *(hole - 1)));
+
+            *hole = std::move(item);
+        }
+    }
+
+    /**
+     * Attempts to insertion sort the range
+     * but gives up after a few moves. Returns
+     * true if the range got sorted
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Compare>
+    bool sort_partial_insertion(Iterator left, Iterator right, Compare & compare) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        if (left == right)
+            return true;
+
+        size_t moves = 0;
+
+        for (auto it = left + 1; it != right; it++) {
+            if (!compare(*it, *(it - 1)))
+                continue;
+
+            T item = std::move(*it);
+            Iterator hole = it;
+
+            do {
+                *hole = std::move(*(hole - 1));
+                hole--;
+            } while (hole != left && compare(item, *(hole - 1)));
+
+            *hole = std::move(item);
+            moves += it - hole;
+
+            if (moves > SORT_PARTIAL_INSERTION_LIMIT)
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Sorts 3 elements in place
+     *
+     *   Time Complexity: O(1)
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Compare>
+    void sort3(Iterator a, Iterator b, Iterator c, Compare & compare) {
+        if (compare(*b, *a)) std::iter_swap(a, b);
+        if (compare(*c, *b)) std::iter_swap(b, c);
+        if (compare(*b, *a)) std::iter_swap(a, b);
+    }
+
+    /**
+     * Partitions around *left. Elements equal
+     * to the pivot go to the right. Returns the
+     * final pivot position and whether nothing
+     * had to be swapped
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Compare>
+    std::pair<Iterator, bool> sort_partition_right(Iterator left, Iterator right, Compare & compare) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        T pivot = std::move(*left);
+        Iterator first = left;
+        Iterator last = right;
+
+        // the median of 3 guarantees both sentinels
+        // except when nothing is less than the pivot
+        while (compare(*++first, pivot));
+
+        if (first - 1 == left) {
+            while (first < last && !compare(*--last, pivot));
+        } else {
+            while (!compare(*--last, pivot));
+        }
+
+        bool partitioned = first >= last;
+
+        while (first < last) {
+            std::iter_swap(first, last);
+            while (compare(*++first, pivot));
+            while (!compare(*--last, pivot));
+        }
+
+        Iterator place = first - 1;
+        *left = std::move(*place);
+        *place = std::move(pivot);
+
+        return { place, partitioned };
+    }
+
+    /**
+     * Same as sort_partition_right but leaves
+     * the bulk of the work to partition_blocks.
+     * Pays off for cheap comparisons of
+     * arithmetic keys
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Compare>
+    std::pair<Iterator, bool> sort_partition_right_branchless(Iterator left, Iterator right, Compare & compare) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        T pivot = std::move(*left);
+        Iterator first = left;
+        Iterator last = right;
+
+        while (compare(*++first, pivot));
+
+        if (first - 1 == left) {
+            while (first < last && !compare(*--last, pivot));
+        } else {
+            while (!compare(*--last, pivot));
+        }
+
+        bool partitioned = first >= last;
+
+        if (!partitioned) {
+            std::iter_swap(first, last);
+
+            auto goes_left = [&](auto & item) {
+                return compare(item, pivot);
+            };
+
+            first = partition_blocks(first + 1, last, goes_left);
+        }
+
+        Iterator place = first - 1;
+        *left = std::move(*place);
+        *place = std::move(pivot);
+
+        return { place, partitioned };
+    }
+
+    /**
+     * Partitions around *left putting elements
+     * equal to the pivot to the left. Used when
+     * the pivot equals the element preceding the
+     * range, so that all of them are skipped at once
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Compare>
+    Iterator sort_partition_left(Iterator left, Iterator right, Compare & compare) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        T pivot = std::move(*left);
+        Iterator first = left;
+        Iterator last = right;
+
+        while (compare(pivot, *--last));
+
+        if (last + 1 == right) {
+            while (first < last && !compare(pivot, *++first));
+        } else {
+            while (!compare(pivot, *++first));
+        }
+
+        while (first < last) {
+            std::iter_swap(first, last);
+            while (compare(pivot, *--last));
+            while (!compare(pivot, *++first));
+        }
+
+        *left = std::move(*last);
+        *last = std::move(pivot);
+
+        return last;
+    }
+
+    /**
+     * Swaps 4 elements at quarters of the range
+     * to break the pattern that led to a bad pivot
+     */
+    template <typename Iterator>
+    void sort_shuffle(Iterator left, Iterator right) {
+        size_t size = right - left;
+
+        if (size < SORT_INSERTION_THRESHOLD)
+            return;
+
+        std::iter_swap(left, left + size / 4);
+        std::iter_swap(right - 1, right - size / 4);
+
+        if (size > SORT_NINTHER_THRESHOLD) {
+            std::iter_swap(left + 1, left + (size / 4 + 1));
+            std::iter_swap(left + 2, left + (size / 4 + 2));
+            std::iter_swap(right - 2, right - (size / 4 + 1));
+            std::iter_swap(right - 3, right - (size / 4 + 2));
+        }
+    }
+
+    /**
+     * The main loop of my::sort. Recurses
+     * into the left part, loops on the right one
+     */
+    template <bool Branchless, typename Iterator, typename Compare>
+    void sort_loop(Iterator left, Iterator right, Compare & compare, int bad_allowed, bool leftmost) {
+        while (true) {
+            size_t size = right - left;
+
+            if (size < SORT_INSERTION_THRESHOLD) {
+                if (leftmost) {
+                    sort_insertion<false>(left, right, compare);
+                } else {
+                    sort_insertion<true>(left, right, compare);
+                }
+
+                return;
+            }
+
+            size_t half = size / 2;
+
+            // the pivot goes to *left
+            if (size > SORT_NINTHER_THRESHOLD) {
+                sort3(left, left + half, right - 1, compare);
+                sort3(left + 1, left + (half - 1), right - 2, compare);
+                sort3(left + 2, left + (half + 1), right - 3, compare);
+                sort3(left + (half - 1), left + half, left + (half + 1), compare);
+                std::iter_swap(left, left + half);
+            } else {
+                sort3(left + half, left, right - 1, compare);
+            }
+
+            // the pivot equals the element before the range
+            // which is not greater than anything here, so
+            // there're many equal elements. Skip them all
+            if (!leftmost && !compare(*(left - 1), *left)) {
+                left = sort_partition_left(left, right, compare) + 1;
+                continue;
+            }
+
+            auto result = Branchless
+                ? sort_partition_right_branchless(left, right, compare)
+                : sort_partition_right(left, right, compare);
+
+            Iterator pivot = result.first;
+            size_t left_size = pivot - left;
+            size_t right_size = right - (pivot + 1);
+
+            if (left_size < size / 8 || right_size < size / 8) {
+                if (--bad_allowed == 0) {
+                    heap_sort(left, right, compare);
+                    return;
+                }
+
+                sort_shuffle(left, pivot);
+                sort_shuffle(pivot + 1, right);
+            } else if (result.second &&
+                sort_partial_insertion(left, pivot, compare) &&
+                sort_partial_insertion(pivot + 1, right, compare)) {
+                return;
+            }
+
+            sort_loop<Branchless>(left, pivot, compare, bad_allowed, leftmost);
+            left = pivot + 1;
+            leftmost = false;
+        }
+    }
+
+    /**
+     * True if Compare is a plain < or > over
+     * an arithmetic T, so that comparisons
+     * are cheap and free of side effects
+     */
+    template <typename T, typename Compare>
+    constexpr bool is_branchless_comparison() {
+        return std::is_arithmetic<T>::value && (
+            std::is_same<Compare, std::less<T>>::value ||
+            std::is_same<Compare, std::greater<T>>::value ||
+            std::is_same<Compare, std::less<>>::value ||
+            std::is_same<Compare, std::greater<>>::value
+        );
+    }
+
+    /**
+     * Pattern-defeating quicksort. Finishes small
+     * ranges with insertion sort, takes ninthers as
+     * pivots, groups equal elements, notices already
+     * sorted parts and falls back to heap sort when
+     * pivots keep being bad. Partitions arithmetic
+     * keys without branches. Moves elements rather
+     * than swapping them. Not stable
+     *
+     *   Time Complexity: O(nlogn), n = right - left
+     * Memory Complexity: O(logn)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    void sort(
+        Iterator left,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        if (left == right)
+            return;
+
+        constexpr bool branchless =
+            is_branchless_comparison<T, Compare>() &&
+            std::is_same<Projection, identity>::value;
+
+        projected_compare<Compare, Projection> less { compare, projection };
+        sort_loop<branchless>(left, right, less, bit_width(right - left), true);
+    }
+
+    /**
+     * Partitions around *left. Both scans stop
+     * at elements equal to the pivot, so repeated
+     * keys spread over both parts instead of
+     * piling up in one. Returns the final
+     * pivot position
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Less, typename Swap>
+    Iterator select_partition(Iterator left, Iterator right, Less & less, Swap & swap) {
+        Iterator first = left;
+        Iterator last = right;
+
+        while (true) {
+            while (++first != right && less(*first, *left));
+            // stops at the pivot at the latest
+            while (less(*left, *--last));
+
+            if (first >= last)
+                break;
+
+            swap(*first, *last);
+        }
+
+        if (last != left) {
+            swap(*left, *last);
+        }
+
+        return last;
+    }
+
+    template <bool Blocks, typename Iterator, typename Less, typename Swap>
+    void select_loop(Iterator left, Iterator nth, Iterator right, Less & less, Swap & swap);
+
+    /**
+     * Moves the median of the medians of groups
+     * of 5 to *left. The medians are gathered at
+     * the beginning of the range, so nothing
+     * is allocated
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(logn)
+     */
+    template <bool Blocks, typename Iterator, typename Less, typename Swap>
+    void select_median_of_medians(Iterator left, Iterator right, Less & less, Swap & swap) {
+        size_t groups = 0;
+
+        for (Iterator it = left; right - it >= 5; it += 5) {
+            insertion_sort(it, it + 5, less, identity(), swap);
+            swap(*(left + groups), *(it + 2));
+            groups++;
+        }
+
+        Iterator median = left + groups / 2;
+        select_loop<Blocks>(left, median, left + groups, less, swap);
+        swap(*left, *median);
+    }
+
+    /**
+     * Floyd-Rivest: selects the nth element of
+     * a sample around nth whose size grows as
+     * n^(2/3), so that the sample element lands
+     * very close to the wanted one and the range
+     * shrinks to o(n) after a single partition
+     *
+     *   Time Complexity: O(n^(2/3)), n = right - left
+     * Memory Complexity: O(logn)
+     */
+    template <bool Blocks, typename Iterator, typename Less, typename Swap>
+    void select_sample(Iterator left, Iterator nth, Iterator right, Less & less, Swap & swap) {
+        double size = right - left;
+        double index = nth - left;
+        double log = std::log(size);
+        double sample = 0.5 * std::exp(2 * log / 3);
+        double deviation = 0.5 * std::sqrt(log * sample * (size - sample) / size);
+
+        // leans to the far side, so the pivot
+        // likely leaves the smaller part to nth
+        if (index < size / 2) {
+            deviation = -deviation;
+        }
+
+        double from = index - index * sample / size + deviation;
+        double to = index + (size - index) * sample / size + deviation;
+
+        Iterator sample_left = from > 0 ? left + static_cast<size_t>(from) : left;
+        Iterator sample_right = to < size ? left + static_cast<size_t>(to) : right;
+
+        sample_left = sample_left < nth ? sample_left : nth;
+        sample_right = sample_right > nth ? sample_right : nth + 1;
+
+        // spreads the sample over the whole range
+        // so that sorted or patterned inputs do not
+        // bias it
+        size_t count = sample_right - sample_left;
+        size_t stride = static_cast<size_t>(size) / count;
+
+        for (size_t it = 0; it < count; it++) {
+            swap(*(sample_left + it), *(left + it * stride));
+        }
+
+        select_loop<Blocks>(sample_left, nth, sample_right, less, swap);
+    }
+
+    /**
+     * The main loop of my::nth_element. With
+     * Blocks it partitions three-way and without
+     * branches, and stops as soon as nth gets
+     * among the elements equal to the pivot
+     */
+    template <bool Blocks, typename Iterator, typename Less, typename Swap>
+    void select_loop(Iterator left, Iterator nth, Iterator right, Less & less, Swap & swap) {
+        size_t budget = SELECT_WORK_FACTOR * static_cast<size_t>(right - left);
+
+        while (true) {
+            size_t size = right - left;
+
+            if (size <= SELECT_INSERTION_THRESHOLD) {
+                insertion_sort(left, right, less, identity(), swap);
+                return;
+            }
+
+            // the pivot goes to *left
+            if (budget < size) {
+                select_median_of_medians<Blocks>(left, right, less, swap);
+            } else if (size > SELECT_SAMPLE_THRESHOLD) {
+                select_sample<Blocks>(left, nth, right, less, swap);
+                swap(*left, *nth);
+            } else {
+                Iterator middle = left + size / 2;
+
+                if (less(*middle, *left)) swap(*middle, *left);
+                if (less(*(right - 1), *middle)) swap(*(right - 1), *middle);
+                if (less(*middle, *left)) swap(*middle, *left);
+
+                swap(*left, *middle);
+            }
+
+            budget = budget > size ? budget - size : 0;
+
+            if constexpr (Blocks) {
+                auto equal = block_partition3(left, right, less);
+
+                if (nth < equal.first) {
+                    right = equal.first;
+                } else if (nth >= equal.second) {
+                    left = equal.second;
+                } else {
+                    return;
+                }
+            } else {
+                Iterator pivot = select_partition(left, right, less, swap);
+
+                if (pivot == nth)
+                    return;
+
+                if (nth < pivot) {
+                    right = pivot;
+                } else {
+                    left = pivot + 1;
+                }
+            }
+        }
+    }
+
+    /**
+     * Rearranges the range so that *nth is the
+     * element that would be there if the range
+     * was sorted, no element before it is greater
+     * and no element after it is less. Introselect:
+     * pivots come from Floyd-Rivest samples on long
+     * ranges and medians of 3 on short ones, with
+     * a median of medians fallback if the pivots
+     * keep being bad. Arithmetic keys are partitioned
+     * three-way without branches. Does not allocate
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(logn)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void nth_element(
+        Iterator left,
+        Iterator nth,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        if (nth == right)
+            return;
+
+        constexpr bool blocks =
+            is_branchless_comparison<T, Compare>() &&
+            std::is_same<Projection, identity>::value &&
+            std::is_same<Swap, swapper>::value;
+
+        projected_compare<Compare, Projection> less { compare, projection };
+        select_loop<blocks>(left, nth, right, less, swap);
+    }
+
+    /**
+     * Returns an element that would be located
+     * at a specific position if the container
+     * was sorted. Same as my::nth_element
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(logn)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    Iterator select(
+        Iterator left,
+        Iterator right,
+        size_t index,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        nth_element(left, left + index, right, compare, projection, swap);
+        return left + index;
+    }
+
+    /**
+     * Sorts [left, middle) so that it holds
+     * the elements that would be there if the
+     * whole range was sorted. The rest is left
+     * in no particular order
+     *
+     *   Time Complexity: O(n + klogk), n = right - left, k = middle - left
+     * Memory Complexity: O(logn)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void partial_sort(
+        Iterator left,
+        Iterator middle,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        if (left == middle)
+            return;
+
+        nth_element(left, middle - 1, right, compare, projection, swap);
+
+        // my::sort moves rather than swaps
+        if constexpr (std::is_same<Swap, swapper>::value) {
+            sort(left, middle - 1, compare, projection);
+        } else {
+            heap_sort(left, middle - 1, compare, projection, swap);
+        }
+    }
+
+    /**
+     * Writes the k first elements of [left, right)
+     * in the order of compare, sorted, to output,
+     * e.g. the k greatest ones for std::greater<>.
+     * Reads the input once and does not modify it.
+     * Candidates are copied into a buffer of 2k
+     * elements; once it fills up, nth_element keeps
+     * its best k and the k-th of them becomes the
+     * bar that most elements fail with a single
+     * comparison. Returns the end of the written range
+     *
+     *   Time Complexity: O(n + klogk), n = right - left
+     * Memory Complexity: O(k)
+     */
+    template <
+        typename InputIterator,
+        typename OutputIterator,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    OutputIterator top_k(
+        InputIterator left,
+        InputIterator right,
+        OutputIterator output,
+        size_t k,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
+        using T = typename std::iterator_traits<InputIterator>::value_type;
+
+        if (k == 0)
+            return output;
+
+        projected_compare<Compare, Projection> less { compare, projection };
+
+        // grows with the input, so a short
+        // one does not take 2k elements
+        std::vector<T> buffer;
+        size_t capacity = k <= SIZE_MAX / 2 ? 2 * k : k;
+
+        auto keep_best = [&] {
+            nth_element(buffer.begin(), buffer.begin() + (k - 1), buffer.end(), compare, projection);
+            buffer.erase(buffer.begin() + k, buffer.end());
+        };
+
+        for (; left != right && buffer.size() < capacity; ++left) {
+            buffer.push_back(*left);
+        }
+
+        while (left != right) {
+            keep_best();
+
+            T bar = buffer[k - 1];
+
+            while (buffer.size() < capacity) {
+                // most elements fail the bar
+                while (left != right && !less(*left, bar)) {
+                    ++left;
+                }
+
+                if (left == right)
+                    break;
+
+                buffer.push_back(*left);
+                ++left;
+            }
+        }
+
+        if (buffer.size() > k) {
+            keep_best();
+        }
+
+        sort(buffer.begin(), buffer.end(), compare, projection);
+        return std::move(buffer.begin(), buffer.end(), output);
+    }
+
+    /**
+     * Adds the count of elements with every key
+     * to counts, which must hold limit counters.
+     * The keys are key(element) and must be
+     * in [0, limit)
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void counting_histogram(
+        Iterator left,
+        Iterator right,
+        size_t * counts,
+        KeyOf key = KeyOf()
+    ) {
+        for (auto it = left; it != right; ++it) {
+            counts[static_cast<size_t>(std::invoke(key, *it))]++;
+        }
+    }
+
+    /**
+     * Turns counts into the starts of
+     * the keys. Returns the total count
+     *
+     *   Time Complexity: O(k), k = limit
+     * Memory Complexity: O(1)
+     */
+    inline size_t counting_offsets(size_t * counts, size_t limit) noexcept {
+        size_t total = 0;
+
+        for (size_t it = 0; it < limit; it++) {
+            size_t count = counts[it];
+            counts[it] = total;
+            total += count;
+        }
+
+        return total;
+    }
+
+    /**
+     * Counting sort over a caller-provided buffer,
+     * which must be uninitialized storage for at
+     * least n elements. The keys are key(element)
+     * and must be in [0, limit). Stable
+     *
+     *   Time Complexity: O(n + k), n = right - left, k = limit
+     * Memory Complexity: O(k)
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void counting_sort_buffered(
+        Iterator left,
+        Iterator right,
+        size_t limit,
+        typename std::iterator_traits<Iterator>::value_type * buffer,
+        KeyOf key = KeyOf()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        std::unique_ptr<size_t[]> counts(new size_t[limit]());
+        counting_histogram(left, right, counts.get(), key);
+        size_t size = counting_offsets(counts.get(), limit);
+
+        // where every key starts, to know which
+        // elements were constructed on a throw
+        std::unique_ptr<size_t[]> starts(new size_t[limit]);
+        std::copy(counts.get(), counts.get() + limit, starts.get());
+
+        try {
+            for (auto it = left; it != right; ++it) {
+                size_t & place = counts[static_cast<size_t>(std::invoke(key, *it))];
+                new (buffer + place) T(std::move(*it));
+                place++;
+            }
+        } catch (...) {
+            for (size_t value = 0; value < limit; value++) {
+                std::destroy(buffer + starts[value], buffer + counts[value]);
+            }
+
+            throw;
+        }
+
+        try {
+            std::move(buffer, buffer + size, left);
+        } catch (...) {
+            std::destroy(buffer, buffer + size);
+            throw;
+        }
+
+        std::destroy(buffer, buffer + size);
+    }
+
+    /**
+     * Just the counting sort. The keys are
+     * key(element) and must be in [0, limit).
+     * Plain integers are rewritten from the counts,
+     * other elements are moved through a buffer of
+     * n elements. Stable
+     *
+     *   Time Complexity: O(n + k), n = right - left, k = limit
+     * Memory Complexity: O(n + k)
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void counting_sort(
+        Iterator left,
+        Iterator right,
+        size_t limit,
+        KeyOf key = KeyOf()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        if constexpr (std::is_integral<T>::value && std::is_same<KeyOf, identity>::value) {
+            std::unique_ptr<size_t[]> counts(new size_t[limit]());
+            counting_histogram(left, right, counts.get());
+
+            auto it = left;
+
+            for (size_t value = 0; value < limit; value++) {
+                it = std::fill_n(it, counts[value], static_cast<T>(value));
+            }
+        } else {
+            size_t size = std::distance(left, right);
+
+            std::allocator<T> allocator;
+            T * buffer = allocator.allocate(size);
+
+            try {
+                counting_sort_buffered(left, right, limit, buffer, key);
+            } catch (...) {
+                allocator.deallocate(buffer, size);
+                throw;
+            }
+
+            allocator.deallocate(buffer, size);
+        }
+    }
+
+    /**
+     * Maps key to an unsigned integer of the same
+     * size whose order matches the order of keys.
+     * Signed integers get the sign bit flipped.
+     * IEEE floats get all bits flipped if they are
+     * negative and the sign bit flipped otherwise,
+     * so -0.0 goes before +0.0 and NaNs go to the
+     * ends by their sign
+     *
+     *   Time Complexity: O(1)
+     * Memory Complexity: O(1)
+     */
+    template <typename Key>
+    auto radix_key(Key key) noexcept {
+        if constexpr (std::is_floating_point<Key>::value) {
+            static_assert(
+                sizeof(Key) == sizeof(uint32_t) || sizeof(Key) == sizeof(uint64_t),
+                "Key must be an IEEE float or double"
+            );
+
+            using Bits = typename std::conditional<sizeof(Key) == sizeof(uint32_t), uint32_t, uint64_t>::type;
+            constexpr Bits sign = Bits(1) << (8 * sizeof(Bits) - 1);
+
+            Bits bits;
+            std::memcpy(&bits, &key, sizeof(Key));
+
+            return static_cast<Bits>(bits & sign ? ~bits : bits | sign);
+        } else {
+            static_assert(
+                std::is_integral<Key>::value,
+                "Key must be an integer or a float"
+            );
+
+            using Bits = typename std::make_unsigned<Key>::type;
+
+            if constexpr (std::is_signed<Key>::value) {
+                constexpr Bits sign = Bits(1) << (8 * sizeof(Bits) - 1);
+                return static_cast<Bits>(static_cast<Bits>(key) ^ sign);
+            } else {
+                return static_cast<Bits>(key);
+            }
+        }
+    }
+
+    /**
+     * Moves the elements of [from, from + size) to
+     * to, ordered by the digit at shift. Offsets are
+     * the starts of the buckets and are advanced.
+     * Constructs the elements if to is uninitialized
+     */
+    template <bool Construct, typename Source, typename Target, typename KeyOf>
+    void radix_scatter(
+        Source from,
+        size_t size,
+        Target to,
+        size_t * offsets,
+        int shift,
+        size_t mask,
+        KeyOf & key
+    ) {
+        for (size_t it = 0; it < size; it++, ++from) {
+            size_t digit = (radix_key(std::invoke(key, *from)) >> shift) & mask;
+            auto target = to + offsets[digit]++;
+
+            if constexpr (Construct) {
+                new (&*target) typename std::iterator_traits<Target>::value_type(std::move(*from));
+            } else {
+                *target = std::move(*from);
+            }
+        }
+    }
+
+    /**
+     * LSD radix sort over a caller-provided buffer,
+     * which must be uninitialized storage for at
+     * least n elements. The keys are the results of
+     * key(element) mapped by radix_key. Counts the
+     * digits of all passes at once in a single read
+     * of the range, skips the passes where all keys
+     * share the digit and moves the elements back
+     * and forth between the range and the buffer.
+     * Stable
+     *
+     *   Time Complexity: O(wn / d + w2^d / d), w = key bits, d = RADIX_SORT_DIGIT_BITS
+     * Memory Complexity: O(w2^d / d)
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void radix_sort_buffered(
+        Iterator left,
+        Iterator right,
+        typename std::iterator_traits<Iterator>::value_type * buffer,
+        KeyOf key = KeyOf()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+        using Key = decltype(radix_key(std::invoke(key, *left)));
+
+        constexpr int bits = 8 * sizeof(Key);
+        constexpr int digit_bits = bits <= 16 ? RADIX_SORT_SMALL_DIGIT_BITS : RADIX_SORT_DIGIT_BITS;
+        constexpr int passes = (bits + digit_bits - 1) / digit_bits;
+        constexpr size_t buckets = size_t(1) << digit_bits;
+        constexpr size_t mask = buckets - 1;
+
+        size_t size = std::distance(left, right);
+
+        if (size <= RADIX_SORT_INSERTION_THRESHOLD) {
+            insertion_sort(left, right, std::less<>(), [&key](const T & item) {
+                return radix_key(std::invoke(key, item));
+            });
+            return;
+        }
+
+        std::unique_ptr<size_t[]> counts(new size_t[passes * buckets]());
+
+        for (auto it = left; it != right; ++it) {
+            Key bits_of = radix_key(std::invoke(key, *it));
+
+            for (int pass = 0; pass < passes; pass++) {
+                counts[pass * buckets + ((bits_of >> (pass * digit_bits)) & mask)]++;
+            }
+        }
+
+        Key first = radix_key(std::invoke(key, *left));
+        bool in_buffer = false;
+        bool constructed = false;
+
+        for (int pass = 0; pass < passes; pass++) {
+            size_t * offsets = &counts[pass * buckets];
+            int shift = pass * digit_bits;
+
+            // every key has the same digit
+            if (offsets[(first >> shift) & mask] == size)
+                continue;
+
+            size_t total = 0;
+
+            for (size_t digit = 0; digit < buckets; digit++) {
+                size_t count = offsets[digit];
+                offsets[digit] = total;
+                total += count;
+            }
+
+            if (in_buffer) {
+                radix_scatter<false>(buffer, size, left, offsets, shift, mask, key);
+            } else if (constructed) {
+                radix_scatter<false>(left, size, buffer, offsets, shift, mask, key);
+            } else {
+                radix_scatter<true>(left, size, buffer, offsets, shift, mask, key);
+                constructed = true;
+            }
+
+            in_buffer = !in_buffer;
+        }
+
+        if (in_buffer) {
+            std::move(buffer, buffer + size, left);
+        }
+
+        if (constructed) {
+            std::destroy(buffer, buffer + size);
+        }
+    }
+
+    /**
+     * Just the radix sort. Sorts by key(element),
+     * which must be an integer or a float, key may
+     * also be a pointer to a member. Stable.
+     * Allocates a buffer of n elements
+     *
+     *   Time Complexity: O(wn / d), w = key bits, d = RADIX_SORT_DIGIT_BITS
+     * Memory Complexity: O(n),      n = right - left
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void radix_sort(
+        Iterator left,
+        Iterator right,
+        KeyOf key = KeyOf()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        size_t size = std::distance(left, right);
+
+        if (size <= RADIX_SORT_INSERTION_THRESHOLD) {
+            radix_sort_buffered(left, right, nullptr, key);
+            return;
+        }
+
+        std::allocator<T> allocator;
+        T * buffer = allocator.allocate(size);
+
+        try {
+            radix_sort_buffered(left, right, buffer, key);
+        } catch (...) {
+            allocator.deallocate(buffer, size);
+            throw;
+        }
+
+        allocator.deallocate(buffer, size);
+    }
+
+    /**
+     * Returns the byte of the key of the
+     * element at depth plus 1, or 0 if
+     * the key is not that long
+     */
+    template <typename T, typename Projection>
+    int string_character(const T & item, size_t depth, Projection & projection) {
+        std::string_view key = std::invoke(projection, item);
+        return depth < key.size() ? static_cast<unsigned char>(key[depth]) + 1 : 0;
+    }
+
+    /**
+     * Packs the 7 bytes of the key of the element
+     * starting at depth into the high bytes and their
+     * count into the low one, so that the numbers
+     * compare like the keys past depth do as long as
+     * they differ. Equal numbers with a count below 7
+     * mean equal keys
+     */
+    template <typename T, typename Projection>
+    uint64_t string_characters(const T & item, size_t depth, Projection & projection) {
+        std::string_view key = std::invoke(projection, item);
+        size_t count = depth < key.size() ? key.size() - depth : 0;
+        count = count < 7 ? count : 7;
+
+        uint64_t result = 0;
+
+        for (size_t it = 0; it < count; it++) {
+            result |= uint64_t(static_cast<unsigned char>(key[depth + it])) << (56 - 8 * it);
+        }
+
+        return result | count;
+    }
+
+    /**
+     * Insertion sort for string_sort by the
+     * keys past their common prefix of depth.
+     * Custom swaps move the elements by rotations
+     *
+     *   Time Complexity: O(nnw), w = the key length
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Projection, typename Swap>
+    void string_sort_insertion(Iterator left, Iterator right, size_t depth, Projection & projection, Swap & swap) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        auto less = [&](const T & first, const T & second) {
+            std::string_view a = std::invoke(projection, first);
+            std::string_view b = std::invoke(projection, second);
+
+            return a.substr(depth) < b.substr(depth);
+        };
+
+        if constexpr (std::is_same<Swap, swapper>::value) {
+            sort_insertion<false>(left, right, less);
+        } else {
+            insertion_sort(left, right, less, identity(), swap);
+        }
+    }
+
+    /**
+     * Multikey quick sort: splits the range into the
+     * keys whose characters at depth are less, equal
+     * and greater than the pivot ones. Only the equal
+     * part moves on to the next characters. Works on
+     * 7 bytes at a time, cached in a separate array
+     * that is swapped along with the elements, so the
+     * keys themselves are only read once per depth
+     *
+     *   Time Complexity: O(nlogn + D), D = the total length of distinguishing prefixes
+     * Memory Complexity: O(logn + w), w = the key length
+     */
+    template <typename Iterator, typename Projection, typename Swap>
+    void multikey_quick_sort(
+        Iterator left,
+        Iterator right,
+        size_t depth,
+        uint64_t * cache,
+        bool cached,
+        Projection & projection,
+        Swap & swap
+    ) {
+        while (right - left > STRING_SORT_INSERTION_THRESHOLD) {
+            size_t size = right - left;
+
+            if (!cached) {
+                for (size_t it = 0; it < size; it++) {
+                    cache[it] = string_characters(left[it], depth, projection);
+                }
+            }
+
+            uint64_t a = cache[0];
+            uint64_t b = cache[size / 2];
+            uint64_t c = cache[size - 1];
+            uint64_t pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+            // [0, less) < pivot, [less, it) == pivot, [greater, size) > pivot
+            size_t less = 0;
+            size_t it = 0;
+            size_t greater = size;
+
+            while (it != greater) {
+                if (cache[it] < pivot) {
+                    swap(left[less], left[it]);
+                    std::swap(cache[less++], cache[it++]);
+                } else if (cache[it] > pivot) {
+                    greater--;
+                    swap(left[it], left[greater]);
+                    std::swap(cache[it], cache[greater]);
+                } else {
+                    it++;
+                }
+            }
+
+            multikey_quick_sort(left, left + less, depth, cache, true, projection, swap);
+            multikey_quick_sort(left + greater, right, depth, cache + greater, true, projection, swap);
+
+            // the equal keys have all ended
+            if ((pivot & 0xFF) < 7)
+                return;
+
+            right = left + greater;
+            left = left + less;
+            cache = cache + less;
+            cached = false;
+            depth += 7;
+        }
+
+        string_sort_insertion(left, right, depth, projection, swap);
+    }
+
+    /**
+     * Returns the length of the prefix that the
+     * keys of the range share past depth
+     *
+     *   Time Complexity: O(n + D), D = the total length of the prefixes
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename Projection>
+    size_t string_common_prefix(Iterator left, Iterator right, size_t depth, Projection & projection) {
+        std::string_view first = std::invoke(projection, *left);
+        first = first.substr(depth);
+        size_t result = first.size();
+
+        for (auto it = left + 1; it != right && result != 0; it++) {
+            std::string_view key = std::invoke(projection, *it);
+            key = key.substr(depth);
+
+            size_t length = result < key.size() ? result : key.size();
+            size_t same = 0;
+
+            while (same < length && key[same] == first[same]) {
+                same++;
+            }
+
+            result = same;
+        }
+
+        return result;
+    }
+
+    /**
+     * MSD radix sort for string_sort. Distributes
+     * the range by the byte at depth in place in the
+     * manner of the American flag sort, with the
+     * bytes cached in a separate array for locality,
+     * then goes on with every bucket. Skips the
+     * prefix all keys share at once. Loops on the
+     * largest bucket, so the recursion is at most
+     * log_2(n) calls deep, however long the keys
+     *
+     *   Time Complexity: O(n + D), D = the total length of distinguishing prefixes
+     * Memory Complexity: O(logn)
+     */
+    template <typename Iterator, typename Projection, typename Swap>
+    void american_flag_sort(
+        Iterator left,
+        Iterator right,
+        size_t depth,
+        uint64_t * cache,
+        Projection & projection,
+        Swap & swap
+    ) {
+        constexpr size_t buckets = 257;
+
+        size_t counts[buckets];
+        size_t next[buckets];
+        size_t ends[buckets];
+
+        while (right - left >= STRING_SORT_RADIX_THRESHOLD) {
+            size_t size = right - left;
+
+            while (true) {
+                std::fill(counts, counts + buckets, 0);
+
+                for (size_t it = 0; it < size; it++) {
+                    cache[it] = string_character(left[it], depth, projection);
+                    counts[cache[it]]++;
+                }
+
+                if (counts[cache[0]] != size)
+                    break;
+
+                // the keys have all ended
+                if (cache[0] == 0)
+                    return;
+
+                depth += string_common_prefix(left, right, depth, projection);
+            }
+
+            size_t total = 0;
+
+            for (size_t bucket = 0; bucket < buckets; bucket++) {
+                next[bucket] = total;
+                total += counts[bucket];
+                ends[bucket] = total;
+            }
+
+            // every swap puts an element into its bucket
+            for (size_t bucket = 0; bucket < buckets; bucket++) {
+                while (next[bucket] < ends[bucket]) {
+                    size_t it = next[bucket];
+
+                    while (cache[it] != bucket) {
+                        size_t place = next[cache[it]]++;
+                        swap(left[it], left[place]);
+                        std::swap(cache[it], cache[place]);
+                    }
+
+                    next[bucket]++;
+                }
+            }
+
+            // the keys of bucket 0 have ended
+            size_t largest = 1;
+
+            for (size_t bucket = 2; bucket < buckets; bucket++) {
+                if (counts[bucket] > counts[largest]) {
+                    largest = bucket;
+                }
+            }
+
+            for (size_t bucket = 1; bucket < buckets; bucket++) {
+                size_t start = ends[bucket] - counts[bucket];
+                size_t end = ends[bucket];
+
+                if (bucket == largest) {
+                    continue;
+                } else if (end - start >= STRING_SORT_RADIX_THRESHOLD) {
+                    american_flag_sort(left + start, left + end, depth + 1, cache + start, projection, swap);
+                } else if (end - start > 1) {
+                    multikey_quick_sort(left + start, left + end, depth + 1, cache + start, false, projection, swap);
+                }
+            }
+
+            size_t start = ends[largest] - counts[largest];
+
+            right = left + ends[largest];
+            left = left + start;
+            cache = cache + start;
+            depth++;
+        }
+
+        if (right - left > 1) {
+            multikey_quick_sort(left, right, depth, cache, false, projection, swap);
+        }
+    }
+
+    /**
+     * Sorts strings by their bytes as unsigned
+     * characters, like std::string::compare.
+     * Projection must turn an element into something
+     * that converts to std::string_view. Unlike
+     * comparison sorts it never compares the common
+     * prefixes again: large ranges are distributed
+     * by MSD radix sort, middle ones are split by
+     * multikey quick sort and small ones are
+     * insertion sorted. Allocates 8 bytes per
+     * element to cache characters. Not stable
+     *
+     *   Time Complexity: O(nlogn + D), D = the total length of distinguishing prefixes
+     * Memory Complexity: O(n + w),     w = the key length
+     */
+    template <
+        typename Iterator,
+        typename Projection = identity,
+        typename Swap = swapper
+    >
+    void string_sort(
+        Iterator left,
+        Iterator right,
+        Projection projection = Projection(),
+        Swap swap = Swap()
+    ) {
+        size_t size = std::distance(left, right);
+
+        if (size <= STRING_SORT_INSERTION_THRESHOLD) {
+            string_sort_insertion(left, right, 0, projection, swap);
+            return;
+        }
+
+        std::unique_ptr<uint64_t[]> cache(new uint64_t[size]);
+
+        if (size < STRING_SORT_RADIX_THRESHOLD) {
+            multikey_quick_sort(left, right, 0, cache.get(), false, projection, swap);
+        } else {
+            american_flag_sort(left, right, 0, cache.get(), projection, swap);
+        }
+    }
+
+    /**
+     * Returns 0, 1, ..., n - 1 as Index.
+     * Throws std::length_error if
+     * Index can not hold n
+     */
+    template <typename Index>
+    fast_vector<Index> identity_permutation(size_t size) {
+        static_assert(
+            std::is_unsigned<Index>::value,
+            "Index must be an unsigned integer"
+        );
+
+        if (size > 0 && size - 1 > std::numeric_limits<Index>::max())
+            throw std::length_error("Index can not hold the positions of the elements");
+
+        fast_vector<Index> result(size, 0);
+
+        for (size_t it = 0; it < size; it++) {
+            result[it] = static_cast<Index>(it);
+        }
+
+        return result;
+    }
+
+    /**
+     * Returns the positions of the elements in sorted
+     * order: left[result[0]] goes first. The range
+     * itself is not changed. Sorts the positions by
+     * stable_sort, so equal elements keep their order.
+     * Use uint64_t as Index for more than 2^32 elements
+     *
+     *   Time Complexity: O(nlogn), n = right - left
+     * Memory Complexity: O(n)
+     */
+    template <
+        typename Index = uint32_t,
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    fast_vector<Index> argsort(
+        Iterator left,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
+        auto result = identity_permutation<Index>(std::distance(left, right));
+
+        my::stable_sort(result.begin(), result.end(), compare, [&](Index it) -> decltype(auto) {
+            return std::invoke(projection, left[it]);
+        });
+
+        return result;
+    }
+
+    /**
+     * argsort by my::radix_sort: the keys are
+     * key(element) and must be integers or floats.
+     * Equal elements keep their order
+     *
+     *   Time Complexity: O(wn / d), w = key bits, d = RADIX_SORT_DIGIT_BITS
+     * Memory Complexity: O(n),      n = right - left
+     */
+    template <
+        typename Index = uint32_t,
+        typename Iterator,
+        typename KeyOf = identity
+    >
+    fast_vector<Index> radix_argsort(
+        Iterator left,
+        Iterator right,
+        KeyOf key = KeyOf()
+    ) {
+        auto result = identity_permutation<Index>(std::distance(left, right));
+
+        my::radix_sort(result.begin(), result.end(), [&](Index it) {
+            return std::invoke(key, left[it]);
+        });
+
+        return result;
+    }
+
+    /**
+     * Reorders the range in place so that the element
+     * at it becomes the one that was at
+     * left + permutation[it - left], as argsort
+     * returns. Follows the cycles of the permutation
+     * and moves every element once, marking the
+     * visited positions in a bit vector. Every move
+     * waits for the previous one, so it is several
+     * times slower than apply_permutation_buffered
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(n) bits
+     */
+    template <typename Iterator, typename PermutationIterator>
+    void apply_permutation_in_place(
+        Iterator left,
+        Iterator right,
+        PermutationIterator permutation
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        size_t size = std::distance(left, right);
+        std::vector<bool> visited(size, false);
+
+        for (size_t start = 0; start < size; start++) {
+            if (visited[start])
+                continue;
+
+            visited[start] = true;
+            size_t from = permutation[start];
+
+            if (from == start)
+                continue;
+
+            T item = std::move(left[start]);
+            size_t to = start;
+
+            while (from != start) {
+                left[to] = std::move(left[from]);
+                visited[from] = true;
+                to = from;
+                from = permutation[to];
+            }
+
+            left[to] = std::move(item);
+        }
+    }
+
+    /**
+     * apply_permutation over a caller-provided buffer,
+     * which must be uninitialized storage for at least
+     * n elements. Gathers the elements into the buffer
+     * in the new order and moves them back, so the
+     * reads are independent of each other
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(1)
+     */
+    template <typename Iterator, typename PermutationIterator>
+    void apply_permutation_buffered(
+        Iterator left,
+        Iterator right,
+        PermutationIterator permutation,
+        typename std::iterator_traits<Iterator>::value_type * buffer
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        size_t size = std::distance(left, right);
+
+        for (size_t it = 0; it < size; it++) {
+            new (buffer + it) T(std::move(left[permutation[it]]));
+        }
+
+        std::move(buffer, buffer + size, left);
+        std::destroy(buffer, buffer + size);
+    }
+
+    /**
+     * Reorders the range so that the element at it
+     * becomes the one that was at
+     * left + permutation[it - left], as argsort
+     * returns. Allocates a buffer of n elements and
+     * falls back to apply_permutation_in_place
+     * if that fails
+     *
+     *   Time Complexity: O(n), n = right - left
+     * Memory Complexity: O(n)
+     */
+    template <typename Iterator, typename PermutationIterator>
+    void apply_permutation(
+        Iterator left,
+        Iterator right,
+        PermutationIterator permutation
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        size_t size = std::distance(left, right);
+
+        std::allocator<T> allocator;
+        T * buffer;
+
+        try {
+            buffer = allocator.allocate(size);
+        } catch (const std::bad_alloc &) {
+            apply_permutation_in_place(left, right, permutation);
+            return;
+        }
+
+        try {
+            apply_permutation_buffered(left, right, permutation, buffer);
+        } catch (...) {
+            allocator.deallocate(buffer, size);
+            throw;
+        }
+
+        allocator.deallocate(buffer, size);
+    }
+
+    /**
+     * Sorts the keys in [left, right) and reorders
+     * every array starting at values the same way.
+     * Finds the order once, by radix sort for integer
+     * and float keys other than bool and by stable_sort
+     * otherwise, then applies it to every array. Unlike sorting
+     * tuples it only moves an array's elements once.
+     * Stable
+     *
+     *   Time Complexity: O(nlogn + kn), k = the count of arrays
+     * Memory Complexity: O(n),          n = right - left
+     */
+    template <typename Iterator, typename... Iterators>
+    void sort_by_key(
+        Iterator left,
+        Iterator right,
+        Iterators... values
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        auto reorder = [&](auto index) {
+            using Index = decltype(index);
+            fast_vector<Index> order;
+
+            // bool has no radix key
+            constexpr bool radix =
+                (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+                std::is_floating_point<T>::value;
+
+            if constexpr (radix) {
+                order = radix_argsort<Index>(left, right);
+            } else {
+                order = argsort<Index>(left, right);
+            }
+
+            apply_permutation(left, right, order.begin());
+            (apply_permutation(values, values + (right - left), order.begin()), ...);
+        };
+
+        // narrow positions move less memory
+        if (static_cast<size_t>(std::distance(left, right)) <= std::numeric_limits<uint32_t>::max()) {
+            reorder(uint32_t());
+        } else {
+            reorder(size_t());
         }
     }
 }
@@ -9,6 +9,17 @@
 #include "algorithm.h"
 #include "../fast_vector/fast_vector.h"
 
+// for the reference std::sort
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <list>
+#include <random>
+#include <limits>
+#include <cmath>
+#include <chrono>
+#include <stdexcept>
+
 
 TEST(algorithm_tests, max) {
     ASSERT_EQ(my::max( 10,  20),  20);
@@ -27,6 +38,9 @@ TEST(algorithm_tests, bit_width) {
     ASSERT_EQ(my::bit_width( 1), 1);
     ASSERT_EQ(my::bit_width( 0), 0);
     ASSERT_EQ(my::bit_width(31), 5);
+    ASSERT_EQ(my::bit_width(-1), 32);
+    ASSERT_EQ(my::bit_width((char) -1), 8);
+    ASSERT_EQ(my::bit_width(1ull << 63), 64);
 }
 
 
@@ -89,15 +103,39 @@ void print_contents(const Iterable & things) {
 }
 
 
+/**
+ * Fills a vector with one of the
+ * input patterns sorts must handle
+ */
+my::fast_vector<int> make_pattern(int pattern, int size) {
+    my::fast_vector<int> numbers;
+
+    for (int it = 0; it < size; it++) {
+        switch (pattern) {
+            case 0: numbers.push_back(rand()); break;
+            case 1: numbers.push_back(it); break;
+            case 2: numbers.push_back(size - it); break;
+            case 3: numbers.push_back(42); break;
+            case 4: numbers.push_back(rand() % 4); break;
+            case 5: numbers.push_back(it < size / 2 ? it : size - it); break;
+            case 6: numbers.push_back(it % 100); break;
+            default: numbers.push_back(it % 1000 == 0 ? rand() : it); break;
+        }
+    }
+
+    return numbers;
+}
+
+
 TEST(algorithm_tests, rotate) {
     my::fast_vector<int> numbers = {0, 1, 1, 2, 3, 5, 8, 13, 21};
 
-    auto result = my::rotate(numbers.begin(), numbers.begin() + 3, numbers.end(), std::swap);
+    auto result = my::rotate(numbers.begin(), numbers.begin() + 3, numbers.end(), my::swapper());
     assert_range(numbers, std::initializer_list {2, 3, 5, 8, 13, 21, 0, 1, 1});
     ASSERT_EQ(*result, 0);
 
 
-    result = my::rotate(numbers.begin(), numbers.begin() + 5, numbers.end(), my::fast_swap);
+    result = my::rotate(numbers.begin(), numbers.begin() + 5, numbers.end(), my::fast_swapper());
     assert_range(numbers, std::initializer_list {21, 0, 1, 1, 2, 3, 5, 8, 13});
     ASSERT_EQ(*result, 2);
 }
@@ -105,7 +143,7 @@ TEST(algorithm_tests, rotate) {
 
 TEST(algorithm_tests, insertion_sort) {
     my::fast_vector<int> numbers = {1, 14, 6, 12, 3, 167, 124, 5, 1};
-    my::insertion_sort(numbers.begin(), numbers.end(), my::fast_swap);
+    my::insertion_sort(numbers.begin(), numbers.end(), {}, {}, my::fast_swapper());
     assert_range(numbers, std::initializer_list {1, 1, 3, 5, 6, 12, 14, 124, 167});
 }
 
@@ -124,10 +162,265 @@ TEST(algorithm_tests, merge_sort) {
 }
 
 
+template <typename Sort>
+void assert_sorts_stably(Sort sort) {
+    for (int size : {0, 1, 2, 15, 16, 17, 100, 1000, 5000}) {
+        std::vector<std::pair<int, std::string>> items;
+
+        for (int it = 0; it < size; it++) {
+            items.emplace_back(rand() % 10, std::to_string(it));
+        }
+
+        auto expected = items;
+        auto by_key = [](const auto & first, const auto & second) {
+            return first.first < second.first;
+        };
+
+        std::stable_sort(expected.begin(), expected.end(), by_key);
+        sort(items.begin(), items.end(), by_key);
+        ASSERT_TRUE(items == expected);
+    }
+}
+
+
+TEST(algorithm_tests, merge_sort_stable) {
+    assert_sorts_stably([](auto left, auto right, auto compare) {
+        my::merge_sort(left, right, compare);
+    });
+    assert_sorts_stably([](auto left, auto right, auto compare) {
+        my::merge_sort_in_place(left, right, compare);
+    });
+    assert_sorts_stably([](auto left, auto right, auto compare) {
+        using T = typename std::iterator_traits<decltype(left)>::value_type;
+        std::allocator<T> allocator;
+        size_t capacity = (right - left + 1) / 2 + 1;
+        T * buffer = allocator.allocate(capacity);
+        my::merge_sort_buffered(left, right, buffer, compare);
+        allocator.deallocate(buffer, capacity);
+    });
+}
+
+
+TEST(algorithm_tests, stable_sort) {
+    assert_sorts_stably([](auto left, auto right, auto compare) {
+        my::stable_sort(left, right, compare);
+    });
+
+    for (int pattern = 0; pattern < 8; pattern++) {
+        for (int size : {0, 1, 2, 31, 32, 33, 1000, 100000}) {
+            auto numbers = make_pattern(pattern, size);
+            std::vector<int> expected(numbers.begin(), numbers.end());
+            std::sort(expected.begin(), expected.end());
+
+            my::stable_sort(numbers.begin(), numbers.end());
+            assert_range(numbers, expected);
+        }
+    }
+}
+
+
+TEST(algorithm_tests, stable_sort_runs) {
+    // sorted and reversed inputs take a single pass
+    for (int pattern : {1, 2, 3}) {
+        auto numbers = make_pattern(pattern, 100000);
+        size_t comparisons = 0;
+
+        my::stable_sort(numbers.begin(), numbers.end(), [&](int first, int second) {
+            comparisons++;
+            return first < second;
+        });
+
+        ASSERT_LT(comparisons, 100000u);
+    }
+
+    // long runs that barely overlap are merged
+    // by galloping and cost little more than that
+    std::vector<int> runs;
+
+    for (int run : {2, 0, 3, 1}) {
+        for (int it = 0; it < 25000; it++) {
+            runs.push_back(run * 24000 + it);
+        }
+    }
+
+    size_t comparisons = 0;
+
+    my::stable_sort(runs.begin(), runs.end(), [&](int first, int second) {
+        comparisons++;
+        return first < second;
+    });
+
+    ASSERT_TRUE(std::is_sorted(runs.begin(), runs.end()));
+    ASSERT_LT(comparisons, 100000u + 10000u);
+}
+
+
+TEST(algorithm_tests, DISABLED_stable_sort_benchmark) {
+    // random input must not cost more than merge_sort
+    std::mt19937 generator(42);
+    std::vector<int> input(1000000);
+
+    for (auto & it : input) {
+        it = generator();
+    }
+
+    auto measure = [&](auto sort) {
+        double best = std::numeric_limits<double>::max();
+
+        for (int round = 0; round < 9; round++) {
+            auto numbers = input;
+            auto start = std::chrono::steady_clock::now();
+            sort(numbers.begin(), numbers.end());
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = elapsed.count() < best ? elapsed.count() : best;
+        }
+
+        return best;
+    };
+
+    double stable = measure([](auto left, auto right) { my::stable_sort(left, right); });
+    double merge = measure([](auto left, auto right) { my::merge_sort(left, right); });
+
+    std::cout << "stable_sort " << stable << " ms, merge_sort " << merge << " ms" << std::endl;
+}
+
+
+TEST(algorithm_tests, DISABLED_sort_benchmark) {
+    // must keep up with std::sort on every pattern
+    const char * names[] = {"random", "sorted", "reversed", "equal", "4 values", "organ pipe", "sawtooth", "nearly"};
+
+    for (int pattern = 0; pattern < 8; pattern++) {
+        auto input = make_pattern(pattern, 1000000);
+
+        auto measure = [&](auto sort) {
+            double best = std::numeric_limits<double>::max();
+
+            for (int round = 0; round < 5; round++) {
+                std::vector<int> numbers(input.begin(), input.end());
+                auto start = std::chrono::steady_clock::now();
+                sort(numbers.begin(), numbers.end());
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                best = elapsed.count() < best ? elapsed.count() : best;
+            }
+
+            return best;
+        };
+
+        double custom = measure([](auto left, auto right) { my::sort(left, right); });
+        double standard = measure([](auto left, auto right) { std::sort(left, right); });
+
+        std::cout << names[pattern] << ": my::sort " << custom << " ms, std::sort " << standard << " ms" << std::endl;
+    }
+}
+
+
+TEST(algorithm_tests, merge_sort_large) {
+    // used to overflow the stack
+    std::vector<int> numbers(1 << 22);
+
+    for (auto & it : numbers) {
+        it = rand();
+    }
+
+    auto expected = numbers;
+    std::sort(expected.begin(), expected.end());
+
+    my::merge_sort(numbers.begin(), numbers.end());
+    ASSERT_TRUE(numbers == expected);
+}
+
+
 TEST(algorithm_tests, quick_sort) {
     my::fast_vector<int> numbers = {1, 14, 6, 12, 3, 167, 124, 5, 1};
     my::quick_sort(numbers.begin(), numbers.end());
     assert_range(numbers, std::initializer_list {1, 1, 3, 5, 6, 12, 14, 124, 167});
+
+    for (int pattern = 0; pattern < 8; pattern++) {
+        auto numbers = make_pattern(pattern, 10000);
+        std::vector<int> expected(numbers.begin(), numbers.end());
+        std::sort(expected.begin(), expected.end());
+
+        my::quick_sort(numbers.begin(), numbers.end());
+        assert_range(numbers, expected);
+    }
+}
+
+
+TEST(algorithm_tests, partition_branchless) {
+    auto last_digit = [](int item) { return item % 10; };
+
+    for (int pattern = 0; pattern < 8; pattern++) {
+        for (int size : {1, 2, 3, 63, 64, 65, 1000, 100000}) {
+            auto numbers = make_pattern(pattern, size);
+            std::vector<int> sorted(numbers.begin(), numbers.end());
+            std::sort(sorted.begin(), sorted.end());
+
+            auto pivot = numbers.begin() + rand() % size;
+            int value = *pivot;
+            auto place = my::partition_branchless(numbers.begin(), numbers.end(), pivot);
+
+            ASSERT_EQ(*place, value);
+            std::vector<int> result(numbers.begin(), numbers.end());
+            std::sort(result.begin(), result.end());
+            ASSERT_TRUE(result == sorted);
+
+            for (auto it = numbers.begin(); it != numbers.end(); it++) {
+                ASSERT_TRUE(it < place ? *it < value : *it >= value);
+            }
+
+            pivot = numbers.begin() + rand() % size;
+            value = last_digit(*pivot);
+            place = my::partition_branchless(numbers.begin(), numbers.end(), pivot, std::greater<>(), last_digit);
+
+            for (auto it = numbers.begin(); it != numbers.end(); it++) {
+                ASSERT_TRUE(it < place ? last_digit(*it) > value : last_digit(*it) <= value);
+            }
+        }
+    }
+}
+
+
+TEST(algorithm_tests, partition3) {
+    for (int pattern = 0; pattern < 8; pattern++) {
+        for (int size : {1, 2, 3, 63, 64, 65, 1000, 100000}) {
+            auto numbers = make_pattern(pattern, size);
+            std::vector<int> sorted(numbers.begin(), numbers.end());
+            std::sort(sorted.begin(), sorted.end());
+
+            auto pivot = numbers.begin() + rand() % size;
+            int value = *pivot;
+            auto equal = my::partition3(numbers.begin(), numbers.end(), pivot);
+            auto expected = std::equal_range(sorted.begin(), sorted.end(), value);
+
+            ASSERT_EQ(equal.first - numbers.begin(), expected.first - sorted.begin());
+            ASSERT_EQ(equal.second - numbers.begin(), expected.second - sorted.begin());
+            std::vector<int> result(numbers.begin(), numbers.end());
+            std::sort(result.begin(), result.end());
+            ASSERT_TRUE(result == sorted);
+
+            for (auto it = numbers.begin(); it != numbers.end(); it++) {
+                if (it < equal.first) {
+                    ASSERT_LT(*it, value);
+                } else if (it < equal.second) {
+                    ASSERT_EQ(*it, value);
+                } else {
+                    ASSERT_GT(*it, value);
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> words;
+
+    for (int it = 0; it < 1000; it++) {
+        words.push_back(std::to_string(rand() % 7));
+    }
+
+    auto equal = my::partition3(words.begin(), words.end(), words.begin() + 500, std::greater<>());
+
+    for (auto it = words.begin(); it != words.end(); it++) {
+        ASSERT_TRUE(it < equal.first ? *it > *equal.first : it < equal.second ? *it == *equal.first : *it < *equal.first);
+    }
 }
 
 
@@ -142,10 +435,291 @@ TEST(algorithm_tests, select) {
 }
 
 
+TEST(algorithm_tests, nth_element) {
+    for (int pattern = 0; pattern < 8; pattern++) {
+        for (int size : {1, 2, 16, 17, 100, 601, 5000, 100000}) {
+            auto source = make_pattern(pattern, size);
+            std::vector<int> expected(source.begin(), source.end());
+            std::sort(expected.begin(), expected.end());
+
+            for (int index : {0, size / 3, size / 2, size - 1}) {
+                auto numbers = source;
+                auto nth = numbers.begin() + index;
+                my::nth_element(numbers.begin(), nth, numbers.end());
+
+                ASSERT_EQ(*nth, expected[index]);
+
+                for (auto it = numbers.begin(); it != nth; it++) {
+                    ASSERT_LE(*it, *nth);
+                }
+
+                for (auto it = nth; it != numbers.end(); it++) {
+                    ASSERT_GE(*it, *nth);
+                }
+            }
+        }
+    }
+}
+
+
+TEST(algorithm_tests, nth_element_comparisons) {
+    // the median takes about 1.5n comparisons
+    // with sampling, and no pattern goes quadratic
+    for (int pattern = 0; pattern < 8; pattern++) {
+        auto numbers = make_pattern(pattern, 100000);
+        size_t comparisons = 0;
+
+        my::nth_element(numbers.begin(), numbers.begin() + 50000, numbers.end(), [&](int first, int second) {
+            comparisons++;
+            return first < second;
+        });
+
+        ASSERT_LT(comparisons, 100000u * 4);
+    }
+}
+
+
+TEST(algorithm_tests, partial_sort) {
+    for (int pattern = 0; pattern < 8; pattern++) {
+        auto numbers = make_pattern(pattern, 10000);
+        std::vector<int> expected(numbers.begin(), numbers.end());
+        std::sort(expected.begin(), expected.end());
+
+        for (int count : {0, 1, 100, 10000}) {
+            auto copy = numbers;
+            my::partial_sort(copy.begin(), copy.begin() + count, copy.end());
+            ASSERT_TRUE(std::equal(copy.begin(), copy.begin() + count, expected.begin()));
+
+            copy = numbers;
+            my::partial_sort(copy.begin(), copy.begin() + count, copy.end(), {}, {}, my::fast_swap<int>);
+            ASSERT_TRUE(std::equal(copy.begin(), copy.begin() + count, expected.begin()));
+        }
+    }
+}
+
+
+TEST(algorithm_tests, top_k) {
+    for (int pattern = 0; pattern < 8; pattern++) {
+        auto numbers = make_pattern(pattern, 10000);
+        auto source = numbers;
+        std::vector<int> expected(numbers.begin(), numbers.end());
+        std::sort(expected.begin(), expected.end(), std::greater<>());
+
+        for (size_t count : {0, 1, 100, 10000, 20000}) {
+            std::vector<int> result(count);
+            auto end = my::top_k(numbers.begin(), numbers.end(), result.begin(), count, std::greater<>());
+
+            ASSERT_EQ(size_t(end - result.begin()), std::min<size_t>(count, 10000));
+            ASSERT_TRUE(std::equal(result.begin(), end, expected.begin()));
+            ASSERT_TRUE(std::equal(numbers.begin(), numbers.end(), source.begin()));
+        }
+    }
+
+    // a single pass over a list by a projection,
+    // the buffer fills up and is cut many times
+    std::list<std::pair<int, std::string>> records;
+
+    for (int it = 0; it < 20000; it++) {
+        records.push_back({ rand() % 1000, std::to_string(it) });
+    }
+
+    std::vector<std::pair<int, std::string>> expected(records.begin(), records.end());
+    std::stable_sort(expected.begin(), expected.end(), [](auto & first, auto & second) {
+        return first.first < second.first;
+    });
+
+    std::vector<std::pair<int, std::string>> result(50);
+    my::top_k(records.begin(), records.end(), result.begin(), 50, std::less<>(), &std::pair<int, std::string>::first);
+
+    for (size_t it = 0; it < result.size(); it++) {
+        ASSERT_EQ(result[it].first, expected[it].first);
+    }
+}
+
+
+TEST(algorithm_tests, DISABLED_top_k_benchmark) {
+    // must not lose to partial_sort_copy for small k
+    std::mt19937 generator(42);
+    std::vector<int> input(10000000);
+
+    for (auto & it : input) {
+        it = generator();
+    }
+
+    auto measure = [&](auto select) {
+        double best = std::numeric_limits<double>::max();
+
+        for (int round = 0; round < 5; round++) {
+            auto start = std::chrono::steady_clock::now();
+            select();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = elapsed.count() < best ? elapsed.count() : best;
+        }
+
+        return best;
+    };
+
+    for (size_t k : { 10, 1000, 100000, 1000000 }) {
+        std::vector<int> result(k);
+        std::greater<int> compare;
+
+        double top = measure([&] { my::top_k(input.begin(), input.end(), result.begin(), k, compare); });
+        double partial = measure([&] { std::partial_sort_copy(input.begin(), input.end(), result.begin(), result.end(), compare); });
+
+        std::cout << "k = " << k << ": top_k " << top << " ms, partial_sort_copy " << partial << " ms" << std::endl;
+    }
+}
+
+
 TEST(algorithm_tests, heap_sort) {
     my::fast_vector<int> numbers = {1, 14, 6, 12, 3, 167, 124, 5, 1};
     my::heap_sort(numbers.begin(), numbers.end());
     assert_range(numbers, std::initializer_list {1, 1, 3, 5, 6, 12, 14, 124, 167});
+
+    for (int size = 0; size < 200; size++) {
+        my::fast_vector<int> random;
+
+        for (int it = 0; it < size; it++) {
+            random.push_back(rand() % 50);
+        }
+
+        my::heap_sort(random.begin(), random.end(), {}, {}, my::fast_swap<int>);
+
+        for (int it = 1; it < size; it++) {
+            ASSERT_LE(random[it - 1], random[it]);
+        }
+    }
+}
+
+
+struct record {
+    int id;
+    int weight;
+};
+
+
+template <typename Sort>
+void assert_sorts_records(Sort sort) {
+    my::fast_vector<record> records;
+
+    for (int it = 0; it < 300; it++) {
+        records.push_back({ it, rand() % 40 });
+    }
+
+    sort(records.begin(), records.end());
+
+    for (size_t it = 1; it < records.size(); it++) {
+        ASSERT_GE(records[it - 1].weight, records[it].weight);
+    }
+}
+
+
+TEST(algorithm_tests, compare_and_projection) {
+    auto compare = std::greater<>();
+    auto projection = &record::weight;
+
+    assert_sorts_records([&](auto left, auto right) {
+        my::insertion_sort(left, right, compare, projection);
+    });
+    assert_sorts_records([&](auto left, auto right) {
+        my::selection_sort(left, right, compare, projection);
+    });
+    assert_sorts_records([&](auto left, auto right) {
+        my::merge_sort(left, right, compare, projection);
+    });
+    assert_sorts_records([&](auto left, auto right) {
+        my::quick_sort(left, right, compare, projection, my::fast_swapper());
+    });
+    assert_sorts_records([&](auto left, auto right) {
+        my::heap_sort(left, right, compare, projection);
+    });
+    assert_sorts_records([&](auto left, auto right) {
+        my::sort(left, right, compare, projection);
+    });
+
+    my::fast_vector<int> numbers = {1, 14, 6, 12, 3, 167, 124, 5, 1};
+    auto found = my::select(numbers.begin(), numbers.end(), 0, std::greater<>());
+    ASSERT_EQ(*found, 167);
+
+    my::fast_vector<record> records;
+
+    for (int it = 0; it < 3000; it++) {
+        records.push_back({ it, rand() % 100 });
+    }
+
+    auto nth = records.begin() + 100;
+    my::nth_element(records.begin(), nth, records.end(), std::greater<>(), &record::weight, my::fast_swap<record>);
+
+    for (auto it = records.begin(); it != records.end(); it++) {
+        ASSERT_TRUE(it < nth ? it->weight >= nth->weight : it->weight <= nth->weight);
+    }
+
+
+    my::fast_vector<int> sorted = {9, 7, 7, 4, 1};
+    ASSERT_EQ(my::lower_bound(sorted.begin(), sorted.end(), 7, std::greater<>()) - sorted.begin(), 1);
+    ASSERT_EQ(my::upper_bound(sorted.begin(), sorted.end(), 7, std::greater<>()) - sorted.begin(), 3);
+}
+
+
+TEST(algorithm_tests, sort) {
+    my::fast_vector<int> numbers = {1, 14, 6, 12, 3, 167, 124, 5, 1};
+    my::sort(numbers.begin(), numbers.end());
+    assert_range(numbers, std::initializer_list {1, 1, 3, 5, 6, 12, 14, 124, 167});
+
+    for (int pattern = 0; pattern < 8; pattern++) {
+        for (int size : {0, 1, 2, 23, 24, 25, 127, 128, 129, 1000, 100000}) {
+            auto numbers = make_pattern(pattern, size);
+            std::vector<int> expected(numbers.begin(), numbers.end());
+            std::sort(expected.begin(), expected.end());
+
+            my::sort(numbers.begin(), numbers.end());
+            assert_range(numbers, expected);
+        }
+    }
+}
+
+
+TEST(algorithm_tests, sort_compare) {
+    for (int pattern = 0; pattern < 8; pattern++) {
+        auto numbers = make_pattern(pattern, 5000);
+        std::vector<int> expected(numbers.begin(), numbers.end());
+        std::sort(expected.begin(), expected.end(), std::greater<int>());
+
+        my::sort(numbers.begin(), numbers.end(), std::greater<int>());
+        assert_range(numbers, expected);
+    }
+
+    std::vector<std::string> words;
+
+    for (int it = 0; it < 3000; it++) {
+        words.push_back(std::to_string(rand() % 500));
+    }
+
+    auto expected = words;
+    auto by_length = [](const std::string & first, const std::string & second) {
+        return first.size() < second.size() || (first.size() == second.size() && first < second);
+    };
+
+    std::sort(expected.begin(), expected.end(), by_length);
+    my::sort(words.begin(), words.end(), by_length);
+    assert_range(words, expected);
+}
+
+
+TEST(algorithm_tests, sort_comparisons) {
+    // sorted, reversed and equal inputs
+    // must not go quadratic
+    for (int pattern = 1; pattern < 8; pattern++) {
+        auto numbers = make_pattern(pattern, 100000);
+        size_t comparisons = 0;
+
+        my::sort(numbers.begin(), numbers.end(), [&](int first, int second) {
+            comparisons++;
+            return first < second;
+        });
+
+        ASSERT_LT(comparisons, 100000u * 17 * 3);
+    }
 }
 
 
@@ -153,13 +727,398 @@ TEST(algorithm_tests, counting_sort) {
     my::fast_vector<int> numbers = {1, 14, 6, 12, 3, 167, 124, 5, 1};
     my::counting_sort(numbers.begin(), numbers.end(), 168);
     assert_range(numbers, std::initializer_list {1, 1, 3, 5, 6, 12, 14, 124, 167});
+
+    // more equal elements than a char counter holds
+    std::vector<unsigned char> bytes;
+
+    for (int it = 0; it < 100000; it++) {
+        bytes.push_back(rand() % 3);
+    }
+
+    auto expected = bytes;
+    std::sort(expected.begin(), expected.end());
+
+    my::counting_sort(bytes.begin(), bytes.end(), 256);
+    ASSERT_TRUE(bytes == expected);
+}
+
+
+TEST(algorithm_tests, counting_sort_records) {
+    std::vector<std::pair<int, std::string>> records;
+
+    for (int it = 0; it < 50000; it++) {
+        records.push_back({ rand() % 100, std::to_string(it) });
+    }
+
+    auto expected = records;
+    std::stable_sort(expected.begin(), expected.end(), [](auto & first, auto & second) {
+        return first.first < second.first;
+    });
+
+    auto by_key = records;
+    my::counting_sort(by_key.begin(), by_key.end(), 100, &std::pair<int, std::string>::first);
+    ASSERT_TRUE(by_key == expected);
+
+    std::allocator<std::pair<int, std::string>> allocator;
+    auto * buffer = allocator.allocate(records.size());
+
+    my::counting_sort_buffered(records.begin(), records.end(), 100, buffer, [](auto & item) {
+        return item.first;
+    });
+
+    allocator.deallocate(buffer, records.size());
+    ASSERT_TRUE(records == expected);
+
+    size_t counts[100] = {};
+    my::counting_histogram(records.begin(), records.end(), counts, &std::pair<int, std::string>::first);
+
+    for (int key = 0; key < 100; key++) {
+        ASSERT_EQ(counts[key], size_t(std::count_if(records.begin(), records.end(), [&](auto & item) {
+            return item.first == key;
+        })));
+    }
+}
+
+
+TEST(algorithm_tests, counting_sort_exceptions) {
+    std::vector<std::pair<int, std::string>> records;
+
+    // long enough to be allocated, so leaks show
+    for (int it = 0; it < 1000; it++) {
+        records.push_back({ rand() % 10, std::string(32, 'a') + std::to_string(it) });
+    }
+
+    // the histogram takes the first 1000 keys
+    int calls = 0;
+    auto key = [&](auto & item) {
+        if (++calls == 1500)
+            throw std::runtime_error("key");
+
+        return item.first;
+    };
+
+    ASSERT_THROW(my::counting_sort(records.begin(), records.end(), 10, key), std::runtime_error);
 }
 
 
 TEST(algorithm_tests, radix_sort) {
     my::fast_vector<int> numbers = {1, 14, 6, 12, 3, 167, 124, 5, 1};
-    my::radix_sort(numbers.begin(), numbers.end(), 3);
+    my::radix_sort(numbers.begin(), numbers.end());
     assert_range(numbers, std::initializer_list {1, 1, 3, 5, 6, 12, 14, 124, 167});
+
+    for (int pattern = 0; pattern < 8; pattern++) {
+        for (int size : {0, 1, 64, 65, 1000, 100000}) {
+            auto items = make_pattern(pattern, size);
+
+            for (auto it = items.begin(); it != items.end(); it++) {
+                *it -= size / 2;
+            }
+
+            auto expected = items;
+            std::sort(expected.begin(), expected.end());
+
+            my::radix_sort(items.begin(), items.end());
+
+            for (int it = 0; it < size; it++) {
+                ASSERT_EQ(items[it], expected[it]);
+            }
+        }
+    }
+}
+
+
+template <typename T>
+void assert_radix_sorts(std::vector<T> items) {
+    auto expected = items;
+    std::sort(expected.begin(), expected.end());
+
+    my::radix_sort(items.begin(), items.end());
+
+    for (size_t it = 0; it < items.size(); it++) {
+        ASSERT_EQ(items[it], expected[it]);
+    }
+}
+
+
+TEST(algorithm_tests, radix_sort_keys) {
+    std::vector<int64_t> longs;
+    std::vector<uint16_t> shorts;
+    std::vector<int8_t> bytes;
+    std::vector<float> floats;
+    std::vector<double> doubles;
+
+    for (int it = 0; it < 5000; it++) {
+        int64_t random = (int64_t(rand()) << 33) ^ (int64_t(rand()) << 11) ^ rand();
+        longs.push_back(it % 3 == 0 ? -random : random);
+        shorts.push_back(rand());
+        bytes.push_back(rand());
+        floats.push_back((rand() - RAND_MAX / 2) / 1000.0f);
+        doubles.push_back((rand() - RAND_MAX / 2) * 1e-300 * (it % 2 == 0 ? 1e300 : 1));
+    }
+
+    floats.push_back(-std::numeric_limits<float>::infinity());
+    floats.push_back(std::numeric_limits<float>::infinity());
+    floats.push_back(std::numeric_limits<float>::lowest());
+    floats.push_back(std::numeric_limits<float>::denorm_min());
+    floats.push_back(-std::numeric_limits<float>::denorm_min());
+    floats.push_back(0.0f);
+    longs.push_back(std::numeric_limits<int64_t>::min());
+    longs.push_back(std::numeric_limits<int64_t>::max());
+
+    assert_radix_sorts(longs);
+    assert_radix_sorts(shorts);
+    assert_radix_sorts(bytes);
+    assert_radix_sorts(floats);
+    assert_radix_sorts(doubles);
+
+    // -0.0 goes before +0.0
+    std::vector<double> zeros = {0.0, -0.0, 0.0, -0.0, 1.0, -1.0};
+
+    for (int it = 0; it < 100; it++) {
+        zeros.push_back(it % 2 == 0 ? 0.0 : -0.0);
+    }
+
+    my::radix_sort(zeros.begin(), zeros.end());
+    ASSERT_EQ(zeros.front(), -1.0);
+    ASSERT_TRUE(std::signbit(zeros[1]));
+    ASSERT_FALSE(std::signbit(zeros[zeros.size() - 2]));
+}
+
+
+TEST(algorithm_tests, radix_sort_records) {
+    std::vector<std::pair<int, std::string>> records;
+
+    for (int it = 0; it < 20000; it++) {
+        records.push_back({ rand() % 300 - 150, std::to_string(it) });
+    }
+
+    auto expected = records;
+    std::stable_sort(expected.begin(), expected.end(), [](auto & first, auto & second) {
+        return first.first < second.first;
+    });
+
+    auto by_key = records;
+    my::radix_sort(by_key.begin(), by_key.end(), &std::pair<int, std::string>::first);
+    ASSERT_TRUE(by_key == expected);
+
+    // a caller-provided buffer
+    std::allocator<std::pair<int, std::string>> allocator;
+    auto * buffer = allocator.allocate(records.size());
+
+    my::radix_sort_buffered(records.begin(), records.end(), buffer, [](auto & item) {
+        return item.first;
+    });
+
+    allocator.deallocate(buffer, records.size());
+    ASSERT_TRUE(records == expected);
+}
+
+
+std::string make_key(int kind) {
+    static const char * hosts[] = {"https://example.com/", "https://example.org/", "http://a.io/"};
+    std::string key;
+
+    switch (kind) {
+        case 0:
+            // short random keys with all bytes
+            for (int it = rand() % 6; it > 0; it--) {
+                key += static_cast<char>(rand() % 256);
+            }
+            break;
+        case 1:
+            // urls with long common prefixes
+            key = hosts[rand() % 3];
+            key += "users/" + std::to_string(rand() % 1000) + "/posts/" + std::to_string(rand() % 100);
+            break;
+        default:
+            // many equal keys
+            key = std::string(rand() % 3 * 40, 'x');
+            break;
+    }
+
+    return key;
+}
+
+
+TEST(algorithm_tests, string_sort) {
+    for (int kind = 0; kind < 3; kind++) {
+        for (int size : {0, 1, 10, 1000, 50000}) {
+            std::vector<std::string> keys;
+
+            for (int it = 0; it < size; it++) {
+                keys.push_back(make_key(kind));
+            }
+
+            auto expected = keys;
+            std::sort(expected.begin(), expected.end());
+
+            my::string_sort(keys.begin(), keys.end());
+            ASSERT_TRUE(keys == expected);
+        }
+    }
+}
+
+
+TEST(algorithm_tests, string_sort_projection) {
+    std::vector<std::pair<int, std::string>> records;
+
+    for (int it = 0; it < 20000; it++) {
+        records.push_back({ it, make_key(it % 2) });
+    }
+
+    my::string_sort(records.begin(), records.end(), &std::pair<int, std::string>::second);
+
+    for (size_t it = 1; it < records.size(); it++) {
+        ASSERT_LE(records[it - 1].second, records[it].second);
+    }
+
+    std::vector<const char *> names = {"pear", "apple", "", "app", "apples", "banana"};
+    my::string_sort(names.begin(), names.end(), [](const char * name) {
+        return std::string_view(name);
+    });
+
+    std::vector<std::string> sorted(names.begin(), names.end());
+    ASSERT_TRUE(sorted == std::vector<std::string>({"", "app", "apple", "apples", "banana", "pear"}));
+}
+
+
+TEST(algorithm_tests, string_sort_swap) {
+    for (int size : {10, 1000, 50000}) {
+        std::vector<std::string> keys;
+        std::vector<int> payload;
+
+        for (int it = 0; it < size; it++) {
+            keys.push_back(make_key(it % 3));
+            payload.push_back(it);
+        }
+
+        auto original = keys;
+
+        // the payload follows the keys
+        // only if every move is a swap
+        auto swap = [&](std::string & first, std::string & second) {
+            std::swap(first, second);
+            std::swap(payload[&first - keys.data()], payload[&second - keys.data()]);
+        };
+
+        my::string_sort(keys.begin(), keys.end(), my::identity(), swap);
+
+        for (int it = 0; it < size; it++) {
+            ASSERT_TRUE(keys[it] == original[payload[it]]);
+            ASSERT_TRUE(it == 0 || keys[it - 1] <= keys[it]);
+        }
+    }
+}
+
+
+TEST(algorithm_tests, string_sort_long_prefixes) {
+    // every byte splits off a single key, which
+    // used to recurse once per byte and overflow the stack
+    std::vector<std::string> keys;
+
+    for (int it = 0; it < 12000; it++) {
+        keys.push_back(std::string(it, 'a') + "b");
+    }
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    auto expected = keys;
+    std::sort(expected.begin(), expected.end());
+
+    my::string_sort(keys.begin(), keys.end());
+    ASSERT_TRUE(keys == expected);
+}
+
+TEST(algorithm_tests, argsort) {
+    std::vector<std::string> names = {"pear", "apple", "fig", "apple", "kiwi"};
+
+    auto order = my::argsort(names.begin(), names.end());
+    assert_range(order, std::initializer_list<uint32_t> {1, 3, 2, 4, 0});
+    ASSERT_TRUE(names[0] == "pear");
+
+    auto by_length = my::argsort<uint64_t>(names.begin(), names.end(), std::greater<>(), &std::string::size);
+    assert_range(by_length, std::initializer_list<uint64_t> {1, 3, 0, 4, 2});
+
+    std::vector<double> values;
+
+    for (int it = 0; it < 10000; it++) {
+        values.push_back((rand() % 2000 - 1000) / 8.0);
+    }
+
+    auto radix_order = my::radix_argsort(values.begin(), values.end());
+    auto comparison_order = my::argsort(values.begin(), values.end());
+
+    for (size_t it = 0; it < values.size(); it++) {
+        ASSERT_EQ(radix_order[it], comparison_order[it]);
+    }
+
+    for (size_t it = 1; it < values.size(); it++) {
+        ASSERT_LE(values[radix_order[it - 1]], values[radix_order[it]]);
+    }
+}
+
+
+TEST(algorithm_tests, apply_permutation) {
+    for (int size : {0, 1, 2, 1000}) {
+        std::vector<int> permutation(size);
+        std::vector<std::string> items;
+
+        for (int it = 0; it < size; it++) {
+            permutation[it] = it;
+            items.push_back(std::to_string(it));
+        }
+
+        std::shuffle(permutation.begin(), permutation.end(), std::mt19937(size));
+
+        auto in_place = items;
+
+        my::apply_permutation(items.begin(), items.end(), permutation.begin());
+        my::apply_permutation_in_place(in_place.begin(), in_place.end(), permutation.begin());
+
+        for (int it = 0; it < size; it++) {
+            ASSERT_EQ(items[it], std::to_string(permutation[it]));
+            ASSERT_EQ(in_place[it], items[it]);
+        }
+    }
+}
+
+
+TEST(algorithm_tests, sort_by_key) {
+    std::vector<int> keys;
+    std::vector<std::string> names;
+    my::fast_vector<double> weights;
+
+    for (int it = 0; it < 5000; it++) {
+        keys.push_back(rand() % 100);
+        names.push_back(std::to_string(keys.back()) + "/" + std::to_string(it));
+        weights.push_back(keys.back() + it / 10000.0);
+    }
+
+    my::sort_by_key(keys.begin(), keys.end(), names.begin(), weights.begin());
+
+    for (size_t it = 0; it < keys.size(); it++) {
+        ASSERT_EQ(std::stoi(names[it]), keys[it]);
+        ASSERT_EQ(int(weights[it]), keys[it]);
+
+        // equal keys keep their order
+        if (it > 0 && keys[it - 1] == keys[it]) {
+            ASSERT_LT(weights[it - 1], weights[it]);
+        }
+    }
+
+    std::vector<std::string> words = {"b", "c", "a"};
+    std::vector<int> ranks = {2, 3, 1};
+
+    my::sort_by_key(words.begin(), words.end(), ranks.begin());
+    ASSERT_TRUE(ranks == std::vector<int>({1, 2, 3}));
+
+    // bool keys go to the stable sort
+    my::fast_vector<bool> flags = {true, false, true, false};
+    std::vector<int> tags = {0, 1, 2, 3};
+
+    my::sort_by_key(flags.begin(), flags.end(), tags.begin());
+    assert_range(flags, std::initializer_list<bool> {false, false, true, true});
+    ASSERT_TRUE(tags == std::vector<int>({1, 3, 0, 2}));
 }
 
 
@@ -0,0 +1,565 @@
+#pragma once
+
+// for std::atomic
+#include <atomic>
+// for std::thread
+#include <thread>
+// for std::mutex
+#include <mutex>
+// for std::condition_variable
+#include <condition_variable>
+// for std::unique_ptr
+#include <memory>
+// for std::decay
+#include <type_traits>
+// for std::forward
+#include <utility>
+// for std::exception_ptr
+#include <exception>
+// for std::chrono::microseconds
+#include <chrono>
+// for int64_t, uint64_t
+#include <cstdint>
+
+#include "../fast_vector/fast_vector.h"
+
+
+/**
+ * Count of tasks a worker deque can hold.
+ * Tasks spawned into a full deque run inline
+ */
+#define EXECUTOR_DEQUE_CAPACITY (1 << 13)
+
+/**
+ * Used to pad per-worker data so that
+ * workers never share a cache line
+ */
+#define EXECUTOR_CACHE_LINE 64
+
+/**
+ * Count of empty polls an idle thread spins
+ * for before it starts yielding the core
+ */
+#define EXECUTOR_SPIN_LIMIT 64
+
+/**
+ * Count of empty polls an idle thread yields
+ * for before it sleeps: a worker until a task
+ * is spawned, a thread in sync for short periods
+ */
+#define EXECUTOR_YIELD_LIMIT 256
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Counts the unfinished tasks spawned
+     * into it. Must outlive them
+     */
+    class task_group {
+    public:
+        task_group() = default;
+
+        task_group(const task_group &) = delete;
+        void operator = (const task_group &) = delete;
+
+        /**
+         * Returns true if every spawned
+         * task has finished
+         */
+        bool done() const noexcept {
+            return the_pending.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class executor;
+
+        std::atomic<size_t> the_pending { 0 };
+        std::mutex the_lock;
+        std::exception_ptr the_error;
+    };
+
+    /**
+     * Pool of threads that balance fork/join
+     * work by stealing. Every worker owns a
+     * Chase-Lev deque: it pushes and pops spawned
+     * tasks at the bottom without locks while idle
+     * threads steal from the top. Threads that are
+     * not workers spawn into a shared locked queue.
+     * A thread waiting in sync runs other tasks in
+     * the meantime, so nested parallelism never
+     * blocks a worker. Idle workers spin, then yield,
+     * then sleep on a condition variable until
+     * a task is spawned or the executor stops
+     */
+    class executor {
+    public:
+        /**
+         * Starts threads - 1 workers, the thread
+         * that calls sync is the last one
+         */
+        explicit executor(size_t threads = std::thread::hardware_concurrency()) {
+            the_thread_count = threads == 0 ? 1 : threads;
+            the_workers.reset(new worker[the_thread_count - 1]);
+
+            for (size_t it = 0; it < the_thread_count - 1; it++) {
+                the_threads.emplace_back(new std::thread([this, it] {
+                    work(it);
+                }));
+            }
+        }
+
+        /**
+         * Waits for the workers to finish
+         * the queued tasks and stops them
+         */
+        ~executor() {
+            the_stopping.store(true, std::memory_order_release);
+
+            {
+                std::lock_guard<std::mutex> guard(the_sleep_lock);
+                the_signals.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            the_wake.notify_all();
+
+            for (auto it = the_threads.begin(); it != the_threads.end(); it++) {
+                (*it)->join();
+                delete *it;
+            }
+        }
+
+        executor(const executor &) = delete;
+        void operator = (const executor &) = delete;
+
+        /**
+         * Returns the count of threads
+         * including the one calling sync
+         */
+        size_t thread_count() const noexcept {
+            return the_thread_count;
+        }
+
+        /**
+         * Returns the executor shared
+         * by the parallel algorithms
+         */
+        static executor & global() {
+            static executor instance;
+            return instance;
+        }
+
+        /**
+         * Queues function to run on some thread
+         * as a part of group
+         *
+         *   Time Complexity: O(1)
+         * Memory Complexity: O(1)
+         */
+        template <typename Function>
+        void spawn(task_group & group, Function && function) {
+            using Stored = typename std::decay<Function>::type;
+
+            group.the_pending.fetch_add(1, std::memory_order_relaxed);
+            task * item = new task_of<Stored>(group, std::forward<Function>(function));
+            auto * owner = current_worker();
+
+            if (owner != nullptr) {
+                if (!owner->tasks.push(item)) {
+                    // the deque is full, which only happens
+                    // with very deep recursion: run inline
+                    execute(item);
+                    return;
+                }
+            } else {
+                std::lock_guard<std::mutex> guard(the_shared_lock);
+                the_shared.push_back(item);
+                the_shared_size.fetch_add(1, std::memory_order_release);
+            }
+
+            wake_one();
+        }
+
+        /**
+         * Runs other tasks until every task
+         * of the group has finished. Rethrows
+         * the first exception of the group
+         */
+        void sync(task_group & group) {
+            size_t idle = 0;
+
+            while (!group.done()) {
+                if (run_one()) {
+                    idle = 0;
+                } else {
+                    back_off(idle);
+                }
+            }
+
+            if (group.the_error) {
+                std::exception_ptr error = group.the_error;
+                group.the_error = nullptr;
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        /**
+         * Type-erased spawned function
+         */
+        struct task {
+            task_group & group;
+
+            explicit task(task_group & owner) : group(owner) {}
+            virtual ~task() = default;
+            virtual void run() = 0;
+        };
+
+        template <typename Function>
+        struct task_of : task {
+            Function function;
+
+            template <typename Argument>
+            task_of(task_group & owner, Argument && argument)
+                : task(owner), function(std::forward<Argument>(argument)) {}
+
+            void run() override {
+                function();
+            }
+        };
+
+        /**
+         * Chase-Lev deque with a fixed capacity.
+         * The owner works at the bottom, thieves
+         * take from the top
+         */
+        class deque {
+        public:
+            /**
+             * Called by the owner only
+             */
+            bool push(task * item) noexcept {
+                int64_t bottom = the_bottom.load(std::memory_order_relaxed);
+                int64_t top = the_top.load(std::memory_order_acquire);
+
+                if (bottom - top >= EXECUTOR_DEQUE_CAPACITY)
+                    return false;
+
+                the_items[bottom & (EXECUTOR_DEQUE_CAPACITY - 1)].store(item, std::memory_order_relaxed);
+                // publishes the task to the thieves
+                the_bottom.store(bottom + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * Called by the owner only
+             */
+            task * pop() noexcept {
+                int64_t bottom = the_bottom.load(std::memory_order_relaxed) - 1;
+                the_bottom.store(bottom, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t top = the_top.load(std::memory_order_relaxed);
+
+                if (top > bottom) {
+                    the_bottom.store(bottom + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                task * item = the_items[bottom & (EXECUTOR_DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+
+                if (top == bottom) {
+                    // the last item, race the thieves for it
+                    if (!the_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                        item = nullptr;
+                    }
+
+                    the_bottom.store(bottom + 1, std::memory_order_relaxed);
+                }
+
+                return item;
+            }
+
+            /**
+             * May be called by any thread
+             */
+            task * steal() noexcept {
+                int64_t top = the_top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t bottom = the_bottom.load(std::memory_order_acquire);
+
+                if (top >= bottom)
+                    return nullptr;
+
+                task * item = the_items[top & (EXECUTOR_DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+
+                if (!the_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    return nullptr;
+
+                return item;
+            }
+
+            /**
+             * May be called by any thread
+             */
+            bool empty() const noexcept {
+                int64_t top = the_top.load(std::memory_order_acquire);
+                return top >= the_bottom.load(std::memory_order_acquire);
+            }
+
+        private:
+            alignas(EXECUTOR_CACHE_LINE) std::atomic<int64_t> the_top { 0 };
+            alignas(EXECUTOR_CACHE_LINE) std::atomic<int64_t> the_bottom { 0 };
+            std::atomic<task *> the_items[EXECUTOR_DEQUE_CAPACITY];
+        };
+
+        struct alignas(EXECUTOR_CACHE_LINE) worker {
+            deque tasks;
+        };
+
+        size_t the_thread_count;
+        std::unique_ptr<worker[]> the_workers;
+        fast_vector<std::thread *> the_threads;
+        std::atomic<bool> the_stopping { false };
+
+        std::mutex the_shared_lock;
+        fast_vector<task *> the_shared;
+        std::atomic<size_t> the_shared_size { 0 };
+
+        std::mutex the_sleep_lock;
+        std::condition_variable the_wake;
+        std::atomic<size_t> the_sleepers { 0 };
+        std::atomic<uint64_t> the_signals { 0 };
+
+        /**
+         * Returns the worker of the calling
+         * thread in this executor if any
+         */
+        worker * current_worker() noexcept {
+            auto & current = this_thread();
+            return current.owner == this ? current.self : nullptr;
+        }
+
+        struct thread_state {
+            executor * owner = nullptr;
+            worker * self = nullptr;
+        };
+
+        static thread_state & this_thread() noexcept {
+            thread_local thread_state state;
+            return state;
+        }
+
+        /**
+         * Per-thread xorshift generator
+         * for choosing victims
+         */
+        static uint64_t random() noexcept {
+            static std::atomic<uint64_t> seeds { 0x9E3779B97F4A7C15ull };
+            thread_local uint64_t state = seeds.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed) | 1;
+
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            return state;
+        }
+
+        /**
+         * The loop of a worker thread
+         */
+        void work(size_t index) {
+            auto & current = this_thread();
+            current.owner = this;
+            current.self = &the_workers[index];
+
+            size_t idle = 0;
+
+            while (true) {
+                if (run_one()) {
+                    idle = 0;
+                } else if (the_stopping.load(std::memory_order_acquire)) {
+                    return;
+                } else if (idle < EXECUTOR_YIELD_LIMIT) {
+                    back_off(idle);
+                } else {
+                    park();
+                    idle = 0;
+                }
+            }
+        }
+
+        /**
+         * Sleeps until a task is spawned or the
+         * executor stops. A spawn either sees the
+         * sleeper counted or its task is seen here
+         * before the worker falls asleep
+         */
+        void park() {
+            uint64_t signal = the_signals.load(std::memory_order_acquire);
+
+            the_sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (!has_work()) {
+                std::unique_lock<std::mutex> guard(the_sleep_lock);
+
+                the_wake.wait(guard, [&] {
+                    return the_signals.load(std::memory_order_relaxed) != signal
+                        || the_stopping.load(std::memory_order_acquire);
+                });
+            }
+
+            the_sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Wakes a sleeping worker
+         * if there is any
+         */
+        void wake_one() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (the_sleepers.load(std::memory_order_relaxed) == 0)
+                return;
+
+            {
+                std::lock_guard<std::mutex> guard(the_sleep_lock);
+                the_signals.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            the_wake.notify_one();
+        }
+
+        /**
+         * Returns true if some queue
+         * holds a task
+         */
+        bool has_work() const noexcept {
+            if (the_shared_size.load(std::memory_order_acquire) != 0)
+                return true;
+
+            for (size_t it = 0; it + 1 < the_thread_count; it++) {
+                if (!the_workers[it].tasks.empty())
+                    return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * Finds a task and runs it. Returns
+         * false if there was none
+         */
+        bool run_one() {
+            auto * owner = current_worker();
+            task * item = owner != nullptr ? owner->tasks.pop() : nullptr;
+
+            if (item == nullptr) {
+                item = steal(owner);
+            }
+
+            if (item == nullptr)
+                return false;
+
+            execute(item);
+            return true;
+        }
+
+        /**
+         * Tries the shared queue and
+         * one random victim
+         */
+        task * steal(worker * thief) {
+            if (the_shared_size.load(std::memory_order_acquire) != 0) {
+                std::lock_guard<std::mutex> guard(the_shared_lock);
+
+                if (!the_shared.empty()) {
+                    task * item = the_shared.back();
+                    the_shared.pop_back();
+                    the_shared_size.fetch_sub(1, std::memory_order_release);
+                    return item;
+                }
+            }
+
+            if (the_thread_count == 1)
+                return nullptr;
+
+            auto & victim = the_workers[random() % (the_thread_count - 1)];
+
+            if (&victim == thief)
+                return nullptr;
+
+            return victim.tasks.steal();
+        }
+
+        /**
+         * Runs the task and reports
+         * the result to its group
+         */
+        static void execute(task * item) {
+            task_group & group = item->group;
+
+            try {
+                item->run();
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(group.the_lock);
+
+                if (!group.the_error) {
+                    group.the_error = std::current_exception();
+                }
+            }
+
+            delete item;
+            group.the_pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        /**
+         * Waits a bit longer after
+         * every empty poll
+         */
+        static void back_off(size_t & idle) {
+            idle++;
+
+            if (idle < EXECUTOR_SPIN_LIMIT) {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+            } else if (idle < EXECUTOR_YIELD_LIMIT) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    };
+
+    /**
+     * Execution policy that makes algorithms
+     * run on an executor, the global one
+     * unless another is given
+     */
+    struct parallel_policy {
+        executor * pool;
+
+        /**
+         * Returns the policy running on pool
+         */
+        parallel_policy operator () (executor & on) const noexcept {
+            return { &on };
+        }
+
+        /**
+         * Returns the executor to run on
+         */
+        executor & get() const {
+            return pool != nullptr ? *pool : executor::global();
+        }
+    };
+
+    /**
+     * Usage: my::sort(my::par, ...) or
+     * my::sort(my::par(pool), ...)
+     */
+    inline constexpr parallel_policy par { nullptr };
+}
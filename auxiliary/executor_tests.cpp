@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+
+#include "executor.h"
+
+
+TEST(executor_tests, runs_all_tasks) {
+    for (size_t threads : {1, 2, 4}) {
+        my::executor pool(threads);
+        my::task_group group;
+        std::atomic<int> counter { 0 };
+
+        for (int it = 0; it < 1000; it++) {
+            pool.spawn(group, [&] {
+                counter++;
+            });
+        }
+
+        pool.sync(group);
+        ASSERT_EQ(counter.load(), 1000);
+        ASSERT_TRUE(group.done());
+    }
+}
+
+
+long fibonacci(my::executor & pool, int n) {
+    if (n < 2)
+        return n;
+
+    long first = 0;
+    my::task_group group;
+
+    pool.spawn(group, [&] {
+        first = fibonacci(pool, n - 1);
+    });
+
+    long second = fibonacci(pool, n - 2);
+    pool.sync(group);
+
+    return first + second;
+}
+
+
+TEST(executor_tests, nested_fork_join) {
+    for (size_t threads : {1, 3}) {
+        my::executor pool(threads);
+        ASSERT_EQ(fibonacci(pool, 20), 6765);
+    }
+}
+
+
+TEST(executor_tests, rethrows) {
+    my::executor pool(2);
+    my::task_group group;
+
+    pool.spawn(group, [] {
+        throw std::runtime_error("failed");
+    });
+
+    ASSERT_THROW(pool.sync(group), std::runtime_error);
+}
+
+
+TEST(executor_tests, wakes_sleeping_workers) {
+    constexpr int threads = 4;
+    my::executor pool(threads);
+
+    for (int round = 0; round < 5; round++) {
+        // long enough for the workers to fall asleep
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        // every task waits for all of them, so
+        // the workers must wake up to run the others
+        my::task_group group;
+        std::atomic<int> arrived { 0 };
+        std::atomic<bool> met { true };
+
+        for (int it = 0; it < threads; it++) {
+            pool.spawn(group, [&] {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                arrived++;
+
+                while (arrived.load() < threads) {
+                    if (std::chrono::steady_clock::now() > deadline) {
+                        met = false;
+                        return;
+                    }
+
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        pool.sync(group);
+        ASSERT_TRUE(met.load());
+    }
+}
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,555 @@
+#pragma once
+
+// for std::less
+#include <functional>
+// for std::FILE
+#include <cstdio>
+// for std::runtime_error
+#include <stdexcept>
+// for std::string
+#include <string>
+// for std::atomic
+#include <atomic>
+// for std::async
+#include <future>
+// for std::vector
+#include <vector>
+// for std::is_trivially_copyable
+#include <type_traits>
+
+#include "../fast_vector/fast_vector.h"
+#include "../heap/loser_tree.h"
+#include "algorithm.h"
+#include "temporary_file.h"
+
+
+/**
+ * Used by default as the memory budget
+ */
+#define EXTERNAL_SORT_DEFAULT_MEMORY (256 << 20)
+
+/**
+ * Used by default as the size of a single
+ * read or write while merging runs
+ */
+#define EXTERNAL_SORT_DEFAULT_BLOCK (1 << 20)
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Sorts files of fixed-size records that may not
+     * fit into memory. The input is read in chunks of
+     * a third of the memory budget, every chunk is
+     * sorted by my::sort and written out as a run
+     * to a temporary file. Three chunk buffers take
+     * turns, so reading the next chunk, sorting the
+     * current one and writing the previous one happen
+     * at the same time. The runs are then merged
+     * through a loser tree, as many at once as there
+     * are read blocks in the budget, in several passes
+     * if needed. The output is written by one block
+     * while the next one is being merged.
+     *
+     * T must be trivially copyable since it is read
+     * and written as is. Only the local filesystem is
+     * used: std::tmpfile by default or files created
+     * exclusively in the given directory. The counters may be read from
+     * another thread while sort runs
+     */
+    template <
+        typename T,
+        typename Compare = std::less<T>
+    >
+    class external_sorter {
+    public:
+        /**
+         * Allows to access template type T.
+         * Despite value_type is defined I prefer
+         * using T.
+         */
+        using value_type = T;
+
+        /**
+         * Allows to access comparator type.
+         * Despite value_compare is defined I prefer
+         * using Compare.
+         */
+        using value_compare = Compare;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using size_type = size_t;
+
+        static_assert(
+            std::is_trivially_copyable<T>::value,
+            "T must be trivially copyable"
+        );
+
+        /**
+         * Constructs a sorter that keeps about
+         * memory bytes in memory and merges runs
+         * by block bytes. Runs are created in
+         * directory if given
+         */
+        explicit external_sorter(
+            size_type memory = EXTERNAL_SORT_DEFAULT_MEMORY,
+            size_type block = EXTERNAL_SORT_DEFAULT_BLOCK,
+            const char * directory = nullptr,
+            const Compare & comparison = Compare()
+        ) : the_comparison(comparison) {
+            // at least 4 blocks fit into the budget
+            block = block * 4 > memory ? memory / 4 : block;
+
+            the_block = block / sizeof(T) == 0 ? 1 : block / sizeof(T);
+            the_chunk = memory / 3 / sizeof(T);
+            the_chunk = the_chunk < the_block ? the_block : the_chunk;
+
+            // one read block per run and two for the output
+            the_fan_in = memory / (the_block * sizeof(T));
+            the_fan_in = the_fan_in < 4 ? 2 : the_fan_in - 2;
+
+            if (directory != nullptr) {
+                the_directory = directory;
+            }
+        }
+
+        external_sorter(const external_sorter &) = delete;
+        void operator = (const external_sorter &) = delete;
+
+        /**
+         * Returns the count of records
+         * of the input being sorted
+         */
+        size_type size() const noexcept {
+            return the_size.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Returns the count of runs
+         * the input was split into
+         */
+        size_type run_count() const noexcept {
+            return the_run_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Returns the count of times every
+         * record is read by the merges
+         */
+        size_type merge_passes() const noexcept {
+            return the_merge_passes.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Returns the count of bytes
+         * written to the files so far
+         */
+        size_type bytes_written() const noexcept {
+            return the_bytes_written.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Returns the count of bytes
+         * read from the files so far
+         */
+        size_type bytes_read() const noexcept {
+            return the_bytes_read.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Returns the share of the reads done
+         * so far, from 0 to 1
+         */
+        double progress() const noexcept {
+            double total = double(size()) * sizeof(T) * (1 + merge_passes());
+            return total == 0 ? 0 : bytes_read() / total;
+        }
+
+        /**
+         * Sorts the records of the input
+         * file into the output file
+         *
+         *   Time Complexity: O(nlogn), plus O(n / B log_{M / B}(n / M)) I/O
+         * Memory Complexity: O(M)
+         */
+        void sort(const char * input, const char * output) {
+            the_bytes_read = 0;
+            the_bytes_written = 0;
+
+            file source(std::fopen(input, "rb"));
+
+            if (source.handle == nullptr)
+                throw std::runtime_error("Could not open the input file");
+
+            std::fseek(source.handle, 0, SEEK_END);
+            long bytes = std::ftell(source.handle);
+            std::rewind(source.handle);
+
+            if (bytes < 0 || bytes % sizeof(T) != 0)
+                throw std::runtime_error("The input is not a whole count of records");
+
+            size_type records = bytes / sizeof(T);
+            size_type chunks = (records + the_chunk - 1) / the_chunk;
+            size_type passes = 0;
+
+            for (size_type runs = chunks; runs > 1; runs = (runs + the_fan_in - 1) / the_fan_in) {
+                passes++;
+            }
+
+            the_size = records;
+            the_run_count = chunks;
+            the_merge_passes = passes;
+
+            file target(std::fopen(output, "wb"));
+
+            if (target.handle == nullptr)
+                throw std::runtime_error("Could not create the output file");
+
+            if (chunks <= 1) {
+                fast_vector<T> buffer(records, T());
+                read(source.handle, buffer.data(), records);
+                my::sort(buffer.begin(), buffer.end(), the_comparison);
+                write(target.handle, buffer.data(), records);
+                target.close();
+                return;
+            }
+
+            std::vector<run> runs = split(source.handle, records, chunks);
+            source.close();
+
+            while (runs.size() > the_fan_in) {
+                std::vector<run> merged;
+
+                for (size_type it = 0; it < runs.size(); it += the_fan_in) {
+                    size_type end = it + the_fan_in < runs.size() ? it + the_fan_in : runs.size();
+                    run result = create();
+
+                    merge(runs, it, end, result);
+                    std::rewind(result.handle);
+                    merged.emplace_back(std::move(result));
+                }
+
+                runs = std::move(merged);
+            }
+
+            run result;
+            result.handle = target.handle;
+            target.handle = nullptr;
+
+            merge(runs, 0, runs.size(), result);
+            result.close();
+        }
+
+    private:
+        /**
+         * Owns a file and removes
+         * it if path is given
+         */
+        struct file {
+            std::FILE * handle = nullptr;
+            std::string path;
+
+            file() = default;
+
+            explicit file(std::FILE * opened) : handle(opened) {}
+
+            file(file && other) noexcept : handle(other.handle), path(std::move(other.path)) {
+                other.handle = nullptr;
+            }
+
+            ~file() {
+                if (handle != nullptr) {
+                    std::fclose(handle);
+                }
+
+                if (!path.empty()) {
+                    std::remove(path.c_str());
+                }
+            }
+
+            void close() {
+                if (handle != nullptr && std::fclose(handle) != 0) {
+                    handle = nullptr;
+                    throw std::runtime_error("Could not close a file");
+                }
+
+                handle = nullptr;
+            }
+        };
+
+        /**
+         * Sorted records in a file,
+         * read back one block at a time
+         */
+        struct run : file {
+            size_type remaining = 0;
+            fast_vector<T> buffer;
+            size_type cursor = 0;
+
+            run() = default;
+            run(run &&) noexcept = default;
+
+            bool exhausted() const noexcept {
+                return cursor == buffer.size();
+            }
+
+            const T & head() const {
+                return buffer[cursor];
+            }
+        };
+
+        /**
+         * Asks the comparison which run goes first
+         */
+        struct beats {
+            run * runs;
+            Compare * comparison;
+
+            bool operator () (size_t first, size_t second) const {
+                auto & a = runs[first];
+                auto & b = runs[second];
+
+                if (a.exhausted())
+                    return false;
+
+                if (b.exhausted())
+                    return true;
+
+                return (*comparison)(a.head(), b.head());
+            }
+        };
+
+        Compare the_comparison;
+        std::string the_directory;
+
+        size_type the_block;
+        size_type the_chunk;
+        size_type the_fan_in;
+
+        std::atomic<size_type> the_size { 0 };
+        std::atomic<size_type> the_run_count { 0 };
+        std::atomic<size_type> the_merge_passes { 0 };
+        std::atomic<size_type> the_bytes_written { 0 };
+        std::atomic<size_type> the_bytes_read { 0 };
+
+        /**
+         * Opens a new file for a run
+         */
+        run create() {
+            run result;
+
+            if (the_directory.empty()) {
+                result.handle = std::tmpfile();
+            } else {
+                result.handle = create_temporary_file(the_directory, "external_sort_", result.path);
+            }
+
+            if (result.handle == nullptr)
+                throw std::runtime_error("Could not create a run file");
+
+            return result;
+        }
+
+        /**
+         * Reads count records
+         */
+        void read(std::FILE * source, T * items, size_type count) {
+            if (std::fread(items, sizeof(T), count, source) != count)
+                throw std::runtime_error("Could not read records");
+
+            the_bytes_read += count * sizeof(T);
+        }
+
+        /**
+         * Writes count records
+         */
+        void write(std::FILE * target, const T * items, size_type count) {
+            if (std::fwrite(items, sizeof(T), count, target) != count)
+                throw std::runtime_error("Could not write records");
+
+            the_bytes_written += count * sizeof(T);
+        }
+
+        /**
+         * Reads the next block of the run
+         */
+        void fill(run & source) {
+            size_type count = source.remaining < the_block ? source.remaining : the_block;
+
+            source.buffer.resize(count);
+            source.cursor = 0;
+
+            if (count == 0)
+                return;
+
+            read(source.handle, source.buffer.data(), count);
+            source.remaining -= count;
+        }
+
+        /**
+         * Moves to the next record of the run
+         */
+        void advance(run & source) {
+            source.cursor++;
+
+            if (source.exhausted() && source.remaining != 0) {
+                fill(source);
+            }
+        }
+
+        /**
+         * Sorts the input chunk by chunk into runs.
+         * Chunk k is read into buffer k % 3 while
+         * chunk k - 1 is sorted and chunk k - 2
+         * is written
+         */
+        std::vector<run> split(std::FILE * source, size_type records, size_type chunks) {
+            std::vector<run> runs;
+            fast_vector<T> buffers[3];
+
+            for (auto & buffer : buffers) {
+                buffer.reserve(the_chunk);
+            }
+
+            // declared after the buffers: destroying
+            // a future waits for the task to finish
+            std::future<void> reading;
+            std::future<void> writing[3];
+
+            auto read_chunk = [this, source, records](fast_vector<T> & buffer, size_type chunk) {
+                size_type start = chunk * the_chunk;
+                size_type count = records - start < the_chunk ? records - start : the_chunk;
+
+                buffer.resize(count);
+                read(source, buffer.data(), count);
+            };
+
+            reading = std::async(std::launch::async, read_chunk, std::ref(buffers[0]), 0);
+
+            for (size_type chunk = 0; chunk < chunks; chunk++) {
+                auto & buffer = buffers[chunk % 3];
+                reading.get();
+
+                if (chunk + 1 < chunks) {
+                    size_type next = (chunk + 1) % 3;
+
+                    if (writing[next].valid()) {
+                        writing[next].get();
+                    }
+
+                    reading = std::async(std::launch::async, read_chunk, std::ref(buffers[next]), chunk + 1);
+                }
+
+                my::sort(buffer.begin(), buffer.end(), the_comparison);
+
+                runs.emplace_back(create());
+                runs.back().remaining = buffer.size();
+
+                std::FILE * target = runs.back().handle;
+
+                writing[chunk % 3] = std::async(std::launch::async, [this, target, &buffer] {
+                    write(target, buffer.data(), buffer.size());
+                });
+            }
+
+            for (auto & pending : writing) {
+                if (pending.valid()) {
+                    pending.get();
+                }
+            }
+
+            for (auto it = runs.begin(); it != runs.end(); it++) {
+                std::rewind(it->handle);
+            }
+
+            return runs;
+        }
+
+        /**
+         * Merges runs [first, last) into target.
+         * The merged runs are closed and removed
+         */
+        void merge(std::vector<run> & runs, size_type first, size_type last, run & target) {
+            size_type count = last - first;
+            size_type total = 0;
+
+            for (size_type it = first; it < last; it++) {
+                total += runs[it].remaining;
+                runs[it].buffer.reserve(the_block);
+                fill(runs[it]);
+            }
+
+            target.remaining = total;
+
+            loser_tree<beats> tree(count, beats { &runs[first], &the_comparison });
+            tree.build();
+
+            fast_vector<T> blocks[2];
+            blocks[0].reserve(the_block);
+            blocks[1].reserve(the_block);
+
+            size_type current = 0;
+            std::future<void> writing;
+
+            auto flush = [&] {
+                if (writing.valid()) {
+                    writing.get();
+                }
+
+                auto & block = blocks[current];
+
+                writing = std::async(std::launch::async, [this, &target, &block] {
+                    write(target.handle, block.data(), block.size());
+                });
+
+                current ^= 1;
+                blocks[current].resize(0);
+            };
+
+            while (!runs[first + tree.winner()].exhausted()) {
+                auto & source = runs[first + tree.winner()];
+                blocks[current].push_back(source.head());
+                advance(source);
+                tree.replay();
+
+                if (blocks[current].size() == the_block) {
+                    flush();
+                }
+            }
+
+            flush();
+            writing.get();
+
+            for (size_type it = first; it < last; it++) {
+                runs[it].close();
+                runs[it].buffer = fast_vector<T>();
+            }
+        }
+    };
+
+    /**
+     * Sorts the fixed-size records of the input file
+     * into the output file with about memory bytes
+     * of memory, see external_sorter
+     *
+     *   Time Complexity: O(nlogn), plus O(n / B log_{M / B}(n / M)) I/O
+     * Memory Complexity: O(M)
+     */
+    template <
+        typename T,
+        typename Compare = std::less<T>
+    >
+    void external_sort(
+        const char * input,
+        const char * output,
+        size_t memory = EXTERNAL_SORT_DEFAULT_MEMORY,
+        Compare compare = Compare()
+    ) {
+        external_sorter<T, Compare> sorter(memory, EXTERNAL_SORT_DEFAULT_BLOCK, nullptr, compare);
+        sorter.sort(input, output);
+    }
+}
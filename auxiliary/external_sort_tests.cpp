@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+// for the reference std::sort
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+#include "external_sort.h"
+
+
+struct record {
+    unsigned long long key;
+    int payload;
+};
+
+
+bool operator < (const record & first, const record & second) {
+    return first.key < second.key;
+}
+
+
+std::string temporary_path(const char * name) {
+    return testing::TempDir() + "/external_sort_tests_" + name;
+}
+
+
+std::vector<record> make_input(const std::string & path, size_t size) {
+    std::vector<record> records;
+
+    for (size_t it = 0; it < size; it++) {
+        records.push_back({ (unsigned long long) rand() * rand() % 1000000, (int) it });
+    }
+
+    std::FILE * file = std::fopen(path.c_str(), "wb");
+    std::fwrite(records.data(), sizeof(record), records.size(), file);
+    std::fclose(file);
+
+    return records;
+}
+
+
+std::vector<record> read_output(const std::string & path) {
+    std::vector<record> records;
+    std::FILE * file = std::fopen(path.c_str(), "rb");
+    record item;
+
+    while (std::fread(&item, sizeof(record), 1, file) == 1) {
+        records.push_back(item);
+    }
+
+    std::fclose(file);
+    std::remove(path.c_str());
+
+    return records;
+}
+
+
+void assert_sorted(std::vector<record> expected, const std::vector<record> & actual) {
+    std::sort(expected.begin(), expected.end(), [](auto & first, auto & second) {
+        return first.key < second.key || (first.key == second.key && first.payload < second.payload);
+    });
+
+    ASSERT_EQ(actual.size(), expected.size());
+
+    for (size_t it = 0; it < actual.size(); it++) {
+        ASSERT_EQ(actual[it].key, expected[it].key);
+
+        if (it > 0 && actual[it - 1].key == actual[it].key)
+            continue;
+
+        // the payloads of equal keys may go in any order
+        auto range = std::equal_range(expected.begin(), expected.end(), actual[it]);
+        ASSERT_TRUE(std::any_of(range.first, range.second, [&](auto & item) {
+            return item.payload == actual[it].payload;
+        }));
+    }
+}
+
+
+TEST(external_sort_tests, in_memory) {
+    auto input = temporary_path("in_memory.in");
+    auto output = temporary_path("in_memory.out");
+    auto records = make_input(input, 1000);
+
+    my::external_sorter<record> sorter;
+    sorter.sort(input.c_str(), output.c_str());
+
+    ASSERT_EQ(sorter.size(), 1000);
+    ASSERT_EQ(sorter.run_count(), 1);
+    ASSERT_EQ(sorter.merge_passes(), 0);
+    ASSERT_EQ(sorter.bytes_read(), 1000 * sizeof(record));
+    ASSERT_EQ(sorter.progress(), 1.0);
+
+    assert_sorted(records, read_output(output));
+    std::remove(input.c_str());
+}
+
+
+TEST(external_sort_tests, single_merge) {
+    auto input = temporary_path("single_merge.in");
+    auto output = temporary_path("single_merge.out");
+    auto records = make_input(input, 100000);
+
+    // chunks of 4000 records, up to 38 runs at once
+    my::external_sorter<record> sorter(64000 * 3, 4800);
+    sorter.sort(input.c_str(), output.c_str());
+
+    ASSERT_EQ(sorter.run_count(), 25);
+    ASSERT_EQ(sorter.merge_passes(), 1);
+    ASSERT_EQ(sorter.bytes_read(), 2 * 100000 * sizeof(record));
+    ASSERT_EQ(sorter.bytes_written(), 2 * 100000 * sizeof(record));
+    ASSERT_EQ(sorter.progress(), 1.0);
+
+    assert_sorted(records, read_output(output));
+    std::remove(input.c_str());
+}
+
+
+TEST(external_sort_tests, several_merges_in_directory) {
+    auto input = temporary_path("several_merges.in");
+    auto output = temporary_path("several_merges.out");
+    auto records = make_input(input, 200000);
+
+    // chunks of 1000 records, 2 runs at once
+    my::external_sorter<record> sorter(48000, 12000, testing::TempDir().c_str());
+    sorter.sort(input.c_str(), output.c_str());
+
+    ASSERT_EQ(sorter.run_count(), 200);
+    ASSERT_EQ(sorter.merge_passes(), 8);
+
+    assert_sorted(records, read_output(output));
+    std::remove(input.c_str());
+}
+
+
+TEST(external_sort_tests, compare) {
+    auto input = temporary_path("compare.in");
+    auto output = temporary_path("compare.out");
+
+    std::FILE * file = std::fopen(input.c_str(), "wb");
+    std::vector<int> numbers;
+
+    for (int it = 0; it < 50000; it++) {
+        numbers.push_back(rand());
+    }
+
+    std::fwrite(numbers.data(), sizeof(int), numbers.size(), file);
+    std::fclose(file);
+
+    my::external_sort<int>(input.c_str(), output.c_str(), 40000, std::greater<int>());
+
+    file = std::fopen(output.c_str(), "rb");
+    std::vector<int> sorted(numbers.size() + 1);
+    ASSERT_EQ(std::fread(sorted.data(), sizeof(int), sorted.size(), file), numbers.size());
+    std::fclose(file);
+    sorted.pop_back();
+
+    std::sort(numbers.begin(), numbers.end(), std::greater<int>());
+    ASSERT_TRUE(sorted == numbers);
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+
+TEST(external_sort_tests, errors) {
+    my::external_sorter<int> sorter;
+    auto output = temporary_path("errors.out");
+
+    ASSERT_THROW(sorter.sort("/nonexistent/input", output.c_str()), std::runtime_error);
+
+    // the runs cannot be created
+    auto input = temporary_path("errors.in");
+    make_input(input, 10000);
+
+    my::external_sorter<record> missing(48000, 12000, "/nonexistent");
+    ASSERT_THROW(missing.sort(input.c_str(), output.c_str()), std::runtime_error);
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
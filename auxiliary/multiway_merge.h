@@ -0,0 +1,536 @@
+#pragma once
+
+// for std::less
+#include <functional>
+// for std::pair
+#include <utility>
+// for std::iterator_traits
+#include <iterator>
+// for std::lower_bound, std::upper_bound, std::copy
+#include <algorithm>
+// for std::addressof
+#include <memory>
+// for std::vector
+#include <vector>
+// for std::conditional, std::make_unsigned
+#include <type_traits>
+
+#include "../fast_vector/fast_vector.h"
+#include "algorithm.h"
+#include "parallel.h"
+
+
+/**
+ * Count of elements in a row taken from the
+ * same range after which multiway_merger
+ * starts copying them in blocks
+ */
+#define MULTIWAY_MERGE_MIN_GALLOP 7
+
+/**
+ * Merges of not more than this many elements
+ * are never split between threads
+ */
+#define MULTIWAY_MERGE_PARALLEL_CUTOFF (1 << 16)
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Merges k sorted ranges given as pairs of
+     * iterators. A loser tree picks the next element
+     * with log_2(k) comparisons. Its nodes keep the
+     * heads of their players: plain numbers by value,
+     * other elements by pointer, so a match never goes
+     * through the ranges, and a match swaps them
+     * without a branch. Once the same range wins
+     * several times in a row, the merger finds how
+     * many of its next elements go before the best
+     * head of the other ranges and copies them at
+     * once. Output is produced on demand by next,
+     * so it can be written out in batches. Stable:
+     * equal elements go in the order of their ranges.
+     *
+     * Empty ranges are dropped and the tree is rebuilt
+     * for the rest, which costs O(k) k times, but spares
+     * every match a check for exhausted players
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>
+    >
+    class multiway_merger {
+    public:
+        /**
+         * Generalizes memory menagement types
+         */
+        using size_type = size_t;
+
+        /**
+         * Sorted range to merge
+         */
+        using range = std::pair<Iterator, Iterator>;
+
+        /**
+         * Takes the ranges in [first, last)
+         */
+        template <typename RangeIterator>
+        multiway_merger(
+            RangeIterator first,
+            RangeIterator last,
+            const Compare & comparison = Compare()
+        ) : the_comparison(comparison) {
+            for (auto it = first; it != last; ++it) {
+                if (it->first != it->second) {
+                    the_ranges.push_back(range(it->first, it->second));
+                    the_remaining += std::distance(it->first, it->second);
+                }
+            }
+
+            build();
+        }
+
+        multiway_merger(const multiway_merger &) = delete;
+        void operator = (const multiway_merger &) = delete;
+
+        /**
+         * Returns the count of elements
+         * that are not merged yet
+         */
+        size_type remaining() const noexcept {
+            return the_remaining;
+        }
+
+        /**
+         * Returns true if every
+         * element is merged
+         */
+        bool empty() const noexcept {
+            return the_remaining == 0;
+        }
+
+        /**
+         * Copies the next limit elements, or all
+         * of them if there are fewer, to output.
+         * Returns the end of the written range
+         *
+         *   Time Complexity: O(mlog_2(k) + k^2), m = limit
+         * Memory Complexity: O(1)
+         */
+        template <typename OutputIterator>
+        OutputIterator next(OutputIterator output, size_type limit) {
+            limit = limit < the_remaining ? limit : the_remaining;
+            the_remaining -= limit;
+
+            while (limit > 0) {
+                size_type winner = the_winner.source;
+                range & source = the_ranges[winner];
+
+                if (winner != the_last) {
+                    the_last = winner;
+                    the_streak = 0;
+                }
+
+                if (++the_streak < MULTIWAY_MERGE_MIN_GALLOP) {
+                    *output = *source.first;
+                    ++output;
+                    ++source.first;
+                    limit--;
+                } else {
+                    Iterator end = block_end(winner);
+                    size_type count = std::distance(source.first, end);
+                    count = count < limit ? count : limit;
+
+                    output = std::copy(source.first, source.first + count, output);
+                    source.first += count;
+                    limit -= count;
+
+                    // the ranges interleave again
+                    if (count < MULTIWAY_MERGE_MIN_GALLOP) {
+                        the_streak = 0;
+                    }
+                }
+
+                if (source.first == source.second) {
+                    drop(winner);
+                } else {
+                    the_winner.key = head_of(source.first);
+                    replay();
+                }
+            }
+
+            return output;
+        }
+
+    private:
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        /**
+         * Plain numbers are cheap to copy and to
+         * compare twice without branches
+         */
+        static constexpr bool cached = is_branchless_comparison<value_type, Compare>();
+
+        using head = typename std::conditional<cached, value_type, const value_type *>::type;
+
+        /**
+         * Player of the tree: the
+         * head of a range and its index
+         */
+        struct entry {
+            head key;
+            size_type source;
+        };
+
+        Compare the_comparison;
+        std::vector<range> the_ranges;
+
+        // losers of the inner nodes 1 .. k - 1
+        fast_vector<entry> the_losers;
+        entry the_winner {};
+
+        size_type the_remaining = 0;
+        size_type the_last = 0;
+        size_type the_streak = 0;
+
+        static head head_of(Iterator position) {
+            if constexpr (cached) {
+                return *position;
+            } else {
+                return std::addressof(*position);
+            }
+        }
+
+        static const value_type & key_of(const entry & item) noexcept {
+            if constexpr (cached) {
+                return item.key;
+            } else {
+                return *item.key;
+            }
+        }
+
+        /**
+         * Returns true if first goes before second:
+         * by the heads, then by the ranges
+         */
+        bool beats(const entry & first, const entry & second) {
+            const value_type & a = key_of(first);
+            const value_type & b = key_of(second);
+
+            if constexpr (cached && std::is_integral<value_type>::value) {
+                // equal integers look the same in any order
+                return the_comparison(a, b);
+            } else if constexpr (cached) {
+                return the_comparison(a, b) | (!the_comparison(b, a) & (first.source < second.source));
+            } else {
+                if (the_comparison(a, b))
+                    return true;
+
+                return first.source < second.source && !the_comparison(b, a);
+            }
+        }
+
+        /**
+         * Swaps the entries if condition holds
+         * without a branch, which would be a coin
+         * toss: integers through masks, other
+         * heads picked by index
+         */
+        static void exchange_if(bool condition, entry & first, entry & second) noexcept {
+            if constexpr (std::is_integral<head>::value && !std::is_same<head, bool>::value) {
+                using bits = typename std::make_unsigned<head>::type;
+
+                bits keys = (bits(first.key) ^ bits(second.key)) & (bits(0) - bits(condition));
+                size_type sources = (first.source ^ second.source) & (size_type(0) - size_type(condition));
+
+                first.key = head(bits(first.key) ^ keys);
+                second.key = head(bits(second.key) ^ keys);
+                first.source ^= sources;
+                second.source ^= sources;
+            } else {
+                entry both[2] = { first, second };
+
+                first = both[condition];
+                second = both[!condition];
+            }
+        }
+
+        /**
+         * Plays all matches from scratch, the
+         * leaves of the ranges are k .. 2k - 1
+         *
+         *   Time Complexity: O(k)
+         * Memory Complexity: O(k)
+         */
+        void build() {
+            size_type count = the_ranges.size();
+            the_losers.resize(count);
+
+            auto leaf = [&](size_type node) {
+                return entry { head_of(the_ranges[node - count].first), node - count };
+            };
+
+            if (count <= 1) {
+                the_winner = count == 0 ? entry {} : leaf(1);
+                return;
+            }
+
+            fast_vector<entry> winners(count, entry {});
+
+            for (size_type node = count - 1; node > 0; node--) {
+                entry left  = 2 * node     < count ? winners[2 * node]     : leaf(2 * node);
+                entry right = 2 * node + 1 < count ? winners[2 * node + 1] : leaf(2 * node + 1);
+
+                if (beats(right, left)) {
+                    std::swap(left, right);
+                }
+
+                winners[node] = left;
+                the_losers[node] = right;
+            }
+
+            the_winner = winners[1];
+        }
+
+        /**
+         * Finds the new winner after
+         * the head of the old one changed
+         *
+         *   Time Complexity: O(log_2(k))
+         * Memory Complexity: O(1)
+         */
+        void replay() {
+            entry current = the_winner;
+
+            for (size_type node = (the_losers.size() + current.source) / 2; node > 0; node /= 2) {
+                entry & loser = the_losers[node];
+
+                exchange_if(beats(loser, current), loser, current);
+            }
+
+            the_winner = current;
+        }
+
+        /**
+         * Returns the range that would win if the
+         * winner left, the winner if it is alone
+         */
+        size_type runner_up() {
+            const entry * best = nullptr;
+
+            for (size_type node = (the_losers.size() + the_winner.source) / 2; node > 0; node /= 2) {
+                const entry & loser = the_losers[node];
+
+                if (best == nullptr || beats(loser, *best)) {
+                    best = &loser;
+                }
+            }
+
+            return best == nullptr ? the_winner.source : best->source;
+        }
+
+        /**
+         * Returns the end of the elements of the
+         * winner that go before every other head
+         */
+        Iterator block_end(size_type winner) {
+            range & source = the_ranges[winner];
+            size_type other = runner_up();
+
+            if (other == winner)
+                return source.second;
+
+            auto & key = *the_ranges[other].first;
+
+            // equal elements of earlier ranges go first
+            if (winner < other)
+                return gallop_upper(source.first, source.second, key, the_comparison);
+
+            return gallop_lower(source.first, source.second, key, the_comparison);
+        }
+
+        /**
+         * Removes the exhausted range, keeping
+         * the order of the rest, and replays
+         * every match
+         */
+        void drop(size_type index) {
+            the_ranges.erase(the_ranges.begin() + index);
+            build();
+
+            the_last = the_ranges.size();
+            the_streak = 0;
+        }
+    };
+
+    /**
+     * Merges the sorted ranges in [first, last),
+     * given as pairs of iterators, to output.
+     * Returns the end of the written range. Stable
+     *
+     *   Time Complexity: O(nlog_2(k)), n = the total length
+     * Memory Complexity: O(k),        k = last - first
+     */
+    template <
+        typename RangeIterator,
+        typename OutputIterator,
+        typename Compare = std::less<>
+    >
+    OutputIterator multiway_merge(
+        RangeIterator first,
+        RangeIterator last,
+        OutputIterator output,
+        Compare compare = Compare()
+    ) {
+        using Iterator = typename std::iterator_traits<RangeIterator>::value_type::first_type;
+
+        multiway_merger<Iterator, Compare> merger(first, last, compare);
+        return merger.next(output, merger.remaining());
+    }
+
+    /**
+     * Finds where to split every range so that the
+     * parts before the splits hold the rank first
+     * elements of the merge: equal elements order
+     * by their range, then by their position. Writes
+     * the lengths of the parts to splits. Bisects the
+     * longest of the windows where the splits may be
+     *
+     *   Time Complexity: O(k^2 log^2 n), n = the longest range
+     * Memory Complexity: O(k),         k = the count of ranges
+     */
+    template <typename Iterator, typename Compare>
+    void multiway_select(
+        const std::pair<Iterator, Iterator> * ranges,
+        size_t count,
+        size_t rank,
+        size_t * splits,
+        Compare & compare
+    ) {
+        fast_vector<size_t> low(count, 0);
+        fast_vector<size_t> high(count, 0);
+
+        for (size_t it = 0; it < count; it++) {
+            high[it] = std::distance(ranges[it].first, ranges[it].second);
+        }
+
+        while (true) {
+            size_t widest = 0;
+
+            for (size_t it = 1; it < count; it++) {
+                if (high[it] - low[it] > high[widest] - low[widest]) {
+                    widest = it;
+                }
+            }
+
+            if (count == 0 || high[widest] == low[widest]) {
+                std::copy(low.begin(), low.end(), splits);
+                return;
+            }
+
+            size_t middle = low[widest] + (high[widest] - low[widest]) / 2;
+            auto & pivot = *(ranges[widest].first + middle);
+            size_t before = 0;
+
+            // the count of elements of every
+            // range that go before the pivot
+            for (size_t it = 0; it < count; it++) {
+                if (it < widest) {
+                    splits[it] = std::upper_bound(ranges[it].first, ranges[it].second, pivot, compare) - ranges[it].first;
+                } else if (it > widest) {
+                    splits[it] = std::lower_bound(ranges[it].first, ranges[it].second, pivot, compare) - ranges[it].first;
+                } else {
+                    splits[it] = middle;
+                }
+
+                before += splits[it];
+            }
+
+            if (before == rank)
+                return;
+
+            for (size_t it = 0; it < count; it++) {
+                if (before < rank) {
+                    low[it] = splits[it] > low[it] ? splits[it] : low[it];
+                } else {
+                    high[it] = splits[it] < high[it] ? splits[it] : high[it];
+                }
+            }
+
+            // the pivot itself goes before the split
+            if (before < rank) {
+                low[widest] = middle + 1;
+            }
+        }
+    }
+
+    /**
+     * Parallel my::multiway_merge. Cuts the output
+     * into one slice per thread, finds the exact parts
+     * of the ranges that make up every slice by
+     * multiway_select and merges the slices at once.
+     * Output must be a random access iterator. Stable
+     *
+     *   Time Complexity: O(nlog_2(k)), O(n / p log_2(k) + k^2 log^2 n) span
+     * Memory Complexity: O(pk)
+     */
+    template <
+        typename RangeIterator,
+        typename OutputIterator,
+        typename Compare = std::less<>
+    >
+    OutputIterator multiway_merge(
+        const parallel_policy & policy,
+        RangeIterator first,
+        RangeIterator last,
+        OutputIterator output,
+        Compare compare = Compare()
+    ) {
+        using Iterator = typename std::iterator_traits<RangeIterator>::value_type::first_type;
+        using range = std::pair<Iterator, Iterator>;
+
+        std::vector<range> ranges;
+        size_t total = 0;
+
+        for (auto it = first; it != last; ++it) {
+            ranges.push_back(range(it->first, it->second));
+            total += std::distance(it->first, it->second);
+        }
+
+        executor & pool = policy.get();
+
+        if (pool.thread_count() == 1 || total <= MULTIWAY_MERGE_PARALLEL_CUTOFF)
+            return multiway_merge(ranges.begin(), ranges.end(), output, compare);
+
+        size_t count = ranges.size();
+        size_t slices = pool.thread_count();
+
+        // splits of slice s are at s * count
+        fast_vector<size_t> splits((slices + 1) * count, 0);
+
+        for (size_t it = 0; it < count; it++) {
+            splits[slices * count + it] = std::distance(ranges[it].first, ranges[it].second);
+        }
+
+        parallel_for(par(pool), size_t(1), slices, [&](size_t slice) {
+            multiway_select(ranges.data(), count, total / slices * slice, &splits[slice * count], compare);
+        }, 1);
+
+        parallel_for(par(pool), size_t(0), slices, [&](size_t slice) {
+            std::vector<range> parts;
+
+            for (size_t it = 0; it < count; it++) {
+                parts.push_back(range(
+                    ranges[it].first + splits[slice * count + it],
+                    ranges[it].first + splits[(slice + 1) * count + it]
+                ));
+            }
+
+            multiway_merge(parts.begin(), parts.end(), output + total / slices * slice, compare);
+        }, 1);
+
+        return output + total;
+    }
+}
@@ -0,0 +1,324 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <queue>
+#include <chrono>
+#include <cmath>
+
+
+#include "multiway_merge.h"
+
+
+/**
+ * Value with the index of its
+ * sequence to check stability
+ */
+struct tagged {
+    int value;
+    size_t tag;
+
+    bool operator == (const tagged & other) const {
+        return value == other.value && tag == other.tag;
+    }
+};
+
+static bool less_value(const tagged & first, const tagged & second) {
+    return first.value < second.value;
+}
+
+/**
+ * Fills count sorted sequences of random
+ * lengths and returns them concatenated
+ */
+static std::vector<tagged> make_sequences(
+    std::vector<std::vector<tagged>> & sequences,
+    size_t count,
+    size_t length,
+    int step
+) {
+    std::vector<tagged> all;
+    sequences.assign(count, {});
+
+    for (size_t it = 0; it < count; it++) {
+        int value = rand() % 10;
+        size_t size = length == 0 ? 0 : rand() % length;
+
+        for (size_t that = 0; that < size; that++) {
+            value += rand() % step;
+            sequences[it].push_back({ value, it });
+            all.push_back({ value, it });
+        }
+    }
+
+    std::stable_sort(all.begin(), all.end(), less_value);
+    return all;
+}
+
+using range = std::pair<std::vector<tagged>::const_iterator, std::vector<tagged>::const_iterator>;
+
+static std::vector<range> ranges_of(const std::vector<std::vector<tagged>> & sequences) {
+    std::vector<range> ranges;
+
+    for (auto & it : sequences) {
+        ranges.push_back(range(it.cbegin(), it.cend()));
+    }
+
+    return ranges;
+}
+
+
+TEST(multiway_merge_tests, merge) {
+    for (size_t count : { 0, 1, 2, 3, 5, 16, 64, 100 }) {
+        for (int step : { 1, 3, 100 }) {
+            std::vector<std::vector<tagged>> sequences;
+            auto expected = make_sequences(sequences, count, 300, step);
+            auto ranges = ranges_of(sequences);
+
+            std::vector<tagged> result(expected.size());
+            auto end = my::multiway_merge(ranges.begin(), ranges.end(), result.begin(), less_value);
+
+            ASSERT_EQ(end, result.end());
+            ASSERT_EQ(result, expected);
+        }
+    }
+}
+
+TEST(multiway_merge_tests, merge_numbers) {
+    // numbers are kept in the tree by value
+    for (size_t count : { 1, 2, 3, 5, 64 }) {
+        std::vector<std::vector<int>> sequences(count);
+        std::vector<int> expected;
+
+        for (auto & it : sequences) {
+            for (int that = rand() % 500; that > 0; that--) {
+                it.push_back(rand() % 100);
+            }
+
+            std::sort(it.begin(), it.end());
+            expected.insert(expected.end(), it.begin(), it.end());
+        }
+
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<std::pair<std::vector<int>::iterator, std::vector<int>::iterator>> ranges;
+
+        for (auto & it : sequences) {
+            ranges.push_back({ it.begin(), it.end() });
+        }
+
+        std::vector<int> result(expected.size());
+        my::multiway_merge(ranges.begin(), ranges.end(), result.begin());
+        ASSERT_EQ(result, expected);
+    }
+
+    // -0.0 and +0.0 are equal, but tell the ranges apart
+    std::vector<double> negative = { -1.0, -0.0, -0.0, 2.0 };
+    std::vector<double> positive = { 0.0, 0.0, 1.0 };
+    std::vector<std::pair<const double *, const double *>> ranges = {
+        { positive.data(), positive.data() + positive.size() },
+        { negative.data(), negative.data() + negative.size() }
+    };
+
+    std::vector<double> result(7);
+    my::multiway_merge(ranges.begin(), ranges.end(), result.begin());
+
+    ASSERT_EQ(result, std::vector<double>({ -1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 2.0 }));
+
+    for (size_t it = 1; it < 5; it++) {
+        ASSERT_EQ(std::signbit(result[it]), it >= 3);
+    }
+}
+
+
+TEST(multiway_merge_tests, merge_blocks) {
+    // sequences that do not interleave
+    // are copied by galloping
+    std::vector<std::vector<int>> sequences(8);
+    std::vector<int> expected;
+
+    for (size_t it = 0; it < sequences.size(); it++) {
+        size_t slot = (it * 5) % sequences.size();
+
+        for (int that = 0; that < 1000; that++) {
+            sequences[it].push_back(int(slot) * 1000 + that);
+        }
+    }
+
+    for (auto & it : sequences) {
+        expected.insert(expected.end(), it.begin(), it.end());
+    }
+
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<std::pair<std::vector<int>::iterator, std::vector<int>::iterator>> ranges;
+
+    for (auto & it : sequences) {
+        ranges.push_back({ it.begin(), it.end() });
+    }
+
+    size_t comparisons = 0;
+    auto counting = [&](int first, int second) {
+        comparisons++;
+        return first < second;
+    };
+
+    std::vector<int> result(expected.size());
+    my::multiway_merge(ranges.begin(), ranges.end(), result.begin(), counting);
+
+    ASSERT_EQ(result, expected);
+    ASSERT_LT(comparisons, expected.size());
+}
+
+TEST(multiway_merge_tests, merger_batches) {
+    for (size_t batch : { 1, 7, 64, 1000 }) {
+        std::vector<std::vector<tagged>> sequences;
+        auto expected = make_sequences(sequences, 10, 500, 2);
+        auto ranges = ranges_of(sequences);
+
+        my::multiway_merger<std::vector<tagged>::const_iterator, bool (*)(const tagged &, const tagged &)> merger(
+            ranges.begin(), ranges.end(), less_value
+        );
+
+        ASSERT_EQ(merger.remaining(), expected.size());
+
+        std::vector<tagged> result;
+
+        while (!merger.empty()) {
+            size_t before = merger.remaining();
+            merger.next(std::back_inserter(result), batch);
+            ASSERT_EQ(merger.remaining(), before - std::min(before, batch));
+        }
+
+        ASSERT_EQ(result, expected);
+        merger.next(std::back_inserter(result), batch);
+        ASSERT_EQ(result.size(), expected.size());
+    }
+}
+
+TEST(multiway_merge_tests, parallel_merge) {
+    my::executor pool(4);
+
+    for (size_t count : { 1, 2, 7, 32 }) {
+        for (int step : { 1, 5 }) {
+            std::vector<std::vector<tagged>> sequences;
+            auto expected = make_sequences(sequences, count, 400000 / count, step);
+            auto ranges = ranges_of(sequences);
+
+            std::vector<tagged> result(expected.size());
+            auto end = my::multiway_merge(my::par(pool), ranges.begin(), ranges.end(), result.begin(), less_value);
+
+            ASSERT_EQ(end, result.end());
+            ASSERT_EQ(result, expected);
+        }
+    }
+}
+
+TEST(multiway_merge_tests, select) {
+    for (size_t count : { 1, 2, 5, 20 }) {
+        std::vector<std::vector<tagged>> sequences;
+        auto expected = make_sequences(sequences, count, 50, 2);
+        auto ranges = ranges_of(sequences);
+        auto compare = less_value;
+
+        for (size_t rank = 0; rank <= expected.size(); rank++) {
+            std::vector<size_t> splits(count);
+            my::multiway_select(ranges.data(), count, rank, splits.data(), compare);
+
+            // the parts hold exactly the first
+            // rank elements of the merge
+            std::vector<tagged> parts;
+
+            for (size_t it = 0; it < count; it++) {
+                parts.insert(parts.end(), sequences[it].begin(), sequences[it].begin() + splits[it]);
+            }
+
+            std::stable_sort(parts.begin(), parts.end(), less_value);
+            ASSERT_EQ(parts, std::vector<tagged>(expected.begin(), expected.begin() + rank));
+        }
+    }
+}
+
+
+TEST(multiway_merge_tests, DISABLED_benchmark) {
+    const size_t count = 64;
+    const size_t size = 1 << 24;
+
+    std::vector<std::vector<int>> sequences(count);
+    std::vector<std::pair<const int *, const int *>> ranges;
+
+    for (auto & it : sequences) {
+        for (size_t that = 0; that < size / count; that++) {
+            it.push_back(rand());
+        }
+
+        std::sort(it.begin(), it.end());
+        ranges.push_back({ it.data(), it.data() + it.size() });
+    }
+
+    std::vector<int> result(size);
+    std::vector<int> buffer(size);
+
+    auto measure = [](auto merge) {
+        double best = 1e9;
+
+        for (int run = 0; run < 5; run++) {
+            auto start = std::chrono::steady_clock::now();
+            merge();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+
+        return best;
+    };
+
+    std::cout << "multiway_merge: " << measure([&] {
+        my::multiway_merge(ranges.begin(), ranges.end(), result.begin());
+    }) << " ms" << std::endl;
+
+    std::cout << "priority_queue: " << measure([&] {
+        using item = std::pair<int, size_t>;
+        std::priority_queue<item, std::vector<item>, std::greater<item>> queue;
+        auto heads = ranges;
+
+        for (size_t it = 0; it < count; it++) {
+            queue.push({ *heads[it].first, it });
+        }
+
+        for (auto output = result.begin(); !queue.empty(); ++output) {
+            auto [value, it] = queue.top();
+            queue.pop();
+            *output = value;
+
+            if (++heads[it].first != heads[it].second) {
+                queue.push({ *heads[it].first, it });
+            }
+        }
+    }) << " ms" << std::endl;
+
+    std::cout << "pairwise std::merge: " << measure([&] {
+        auto end = buffer.begin();
+
+        for (auto & it : ranges) {
+            end = std::copy(it.first, it.second, end);
+        }
+
+        int * from = buffer.data();
+        int * to = result.data();
+
+        for (size_t length = size / count; length < size; length *= 2) {
+            for (size_t it = 0; it < size; it += 2 * length) {
+                std::merge(from + it, from + it + length, from + it + length, from + it + 2 * length, to + it);
+            }
+
+            std::swap(from, to);
+        }
+    }) << " ms" << std::endl;
+}
+
+
+int main(int argc, char ** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+// for std::optional
+#include <optional>
+// for std::vector
+#include <vector>
+// for std::plus
+#include <functional>
+// for std::forward
+#include <utility>
+
+#include "executor.h"
+
+
+/**
+ * Count of chunks per thread the range is
+ * split into when no grain size is given.
+ * More chunks balance uneven work better,
+ * fewer ones spawn fewer tasks
+ */
+#define PARALLEL_CHUNKS_PER_THREAD 8
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Returns the count of elements a single
+     * task handles: grain if it is given,
+     * otherwise enough to make about
+     * PARALLEL_CHUNKS_PER_THREAD chunks
+     * per thread
+     */
+    inline size_t parallel_grain(executor & pool, size_t size, size_t grain) noexcept {
+        if (grain != 0)
+            return grain;
+
+        size_t chunks = pool.thread_count() * PARALLEL_CHUNKS_PER_THREAD;
+        size_t result = (size + chunks - 1) / chunks;
+
+        return result == 0 ? 1 : result;
+    }
+
+    /**
+     * Calls body(chunk) for every chunk in
+     * [first, last). Halves the chunks and spawns
+     * the right half until one is left, so that
+     * the tasks spread over the workers by stealing
+     * rather than from a single queue. Callers
+     * run it inside a task of group, so that an
+     * exception still lets sync wait for the rest
+     */
+    template <typename Body>
+    void parallel_split(
+        executor & pool,
+        task_group & group,
+        size_t first,
+        size_t last,
+        Body & body
+    ) {
+        while (last - first > 1) {
+            size_t middle = first + (last - first) / 2;
+
+            pool.spawn(group, [&pool, &group, middle, last, &body] {
+                parallel_split(pool, group, middle, last, body);
+            });
+
+            last = middle;
+        }
+
+        body(first);
+    }
+
+    /**
+     * Calls function(it) for every it in
+     * [first, last). Index is an integer or
+     * a random access iterator. Chunks of grain
+     * elements run as separate tasks, 0 picks
+     * the grain by the count of threads
+     *
+     *   Time Complexity: O(n), O(n / p + grain + logn) span
+     * Memory Complexity: O(n / grain)
+     */
+    template <typename Index, typename Function>
+    void parallel_for(
+        const parallel_policy & policy,
+        Index first,
+        Index last,
+        Function function,
+        size_t grain = 0
+    ) {
+        if (!(first < last))
+            return;
+
+        executor & pool = policy.get();
+        size_t size = last - first;
+        grain = parallel_grain(pool, size, grain);
+
+        auto body = [&](size_t chunk) {
+            Index from = first + chunk * grain;
+            Index to = size - chunk * grain > grain ? from + grain : last;
+
+            for (; from != to; ++from) {
+                function(from);
+            }
+        };
+
+        task_group group;
+
+        pool.spawn(group, [&] {
+            parallel_split(pool, group, 0, (size + grain - 1) / grain, body);
+        });
+
+        pool.sync(group);
+    }
+
+    /**
+     * Folds [left, right) into init with
+     * reduce. Chunks are folded in parallel and
+     * their results are folded in order, so reduce
+     * must be associative but needs not be
+     * commutative, and init is used once
+     *
+     *   Time Complexity: O(n), O(n / p + grain + n / grain) span
+     * Memory Complexity: O(n / grain)
+     */
+    template <
+        typename Iterator,
+        typename T,
+        typename Reduce = std::plus<>
+    >
+    T parallel_reduce(
+        const parallel_policy & policy,
+        Iterator left,
+        Iterator right,
+        T init,
+        Reduce reduce = Reduce(),
+        size_t grain = 0
+    ) {
+        if (!(left < right))
+            return init;
+
+        executor & pool = policy.get();
+        size_t size = right - left;
+        grain = parallel_grain(pool, size, grain);
+
+        size_t chunks = (size + grain - 1) / grain;
+
+        // T needs not be default constructible
+        std::vector<std::optional<T>> partials(chunks);
+
+        auto body = [&](size_t chunk) {
+            Iterator from = left + chunk * grain;
+            Iterator to = size - chunk * grain > grain ? from + grain : right;
+            T partial = *from;
+
+            for (++from; from != to; ++from) {
+                partial = reduce(std::move(partial), *from);
+            }
+
+            partials[chunk].emplace(std::move(partial));
+        };
+
+        task_group group;
+
+        pool.spawn(group, [&] {
+            parallel_split(pool, group, 0, chunks, body);
+        });
+
+        pool.sync(group);
+
+        for (auto it = partials.begin(); it != partials.end(); it++) {
+            init = reduce(std::move(init), std::move(**it));
+        }
+
+        return init;
+    }
+
+    /**
+     * Writes function(*it) for every it in
+     * [left, right) to the range starting at
+     * output, which may be left itself.
+     * Returns the end of the written range
+     *
+     *   Time Complexity: O(n), O(n / p + grain + logn) span
+     * Memory Complexity: O(n / grain)
+     */
+    template <
+        typename Iterator,
+        typename OutputIterator,
+        typename Function
+    >
+    OutputIterator parallel_transform(
+        const parallel_policy & policy,
+        Iterator left,
+        Iterator right,
+        OutputIterator output,
+        Function function,
+        size_t grain = 0
+    ) {
+        if (!(left < right))
+            return output;
+
+        executor & pool = policy.get();
+        size_t size = right - left;
+        grain = parallel_grain(pool, size, grain);
+
+        auto body = [&](size_t chunk) {
+            Iterator from = left + chunk * grain;
+            Iterator to = size - chunk * grain > grain ? from + grain : right;
+            OutputIterator target = output + chunk * grain;
+
+            for (; from != to; ++from, ++target) {
+                *target = function(*from);
+            }
+        };
+
+        task_group group;
+
+        pool.spawn(group, [&] {
+            parallel_split(pool, group, 0, (size + grain - 1) / grain, body);
+        });
+
+        pool.sync(group);
+
+        return output + (right - left);
+    }
+
+    /**
+     * Calls every function, possibly at the
+     * same time, and waits for all of them.
+     * Rethrows the first exception
+     *
+     *   Time Complexity: O(k)
+     * Memory Complexity: O(k)
+     */
+    template <typename... Functions>
+    void parallel_invoke(
+        const parallel_policy & policy,
+        Functions &&... functions
+    ) {
+        executor & pool = policy.get();
+        task_group group;
+
+        (pool.spawn(group, std::forward<Functions>(functions)), ...);
+        pool.sync(group);
+    }
+}
@@ -0,0 +1,834 @@
+#pragma once
+
+// for std::vector
+#include <vector>
+// for std::unique_ptr
+#include <memory>
+// for uint8_t, uint64_t
+#include <cstdint>
+// for std::is_trivially_copyable
+#include <type_traits>
+// for std::atomic
+#include <atomic>
+// for std::align_val_t
+#include <new>
+
+#include "algorithm.h"
+#include "executor.h"
+#include "parallel.h"
+
+
+/**
+ * Ranges shorter than this are sorted
+ * sequentially by a single task
+ */
+#define PARALLEL_SORT_CUTOFF (1 << 14)
+
+/**
+ * Ranges at least this long are distributed
+ * by sample sort, shorter ones are split
+ * by parallel quick sort
+ */
+#define SAMPLE_SORT_THRESHOLD (1 << 18)
+
+/**
+ * Pools with fewer threads always use parallel
+ * quick sort. Sample sort does about 1.3 times
+ * the work of a sequential sort and takes a
+ * buffer of n elements, which only pays off
+ * once enough threads share that work
+ */
+#define SAMPLE_SORT_MIN_THREADS 4
+
+/**
+ * Binary logarithm of the count of buckets
+ * of sample sort. The element bucket ids
+ * must fit into a byte
+ */
+#define SAMPLE_SORT_LOG_BUCKETS 7
+
+/**
+ * Count of sampled elements per bucket
+ */
+#define SAMPLE_SORT_OVERSAMPLING 16
+
+/**
+ * Bits per digit of parallel radix sort for
+ * keys of 32 bits and more. Every thread keeps
+ * a write-combining line per digit value,
+ * which should fit into the L2 cache
+ */
+#define PARALLEL_RADIX_SORT_DIGIT_BITS 11
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Parallel quick sort: partitions the range
+     * sequentially, hands the left part to another
+     * task and goes on with the right one until
+     * the parts are short enough for my::sort.
+     * Pivots, the branchless partition of arithmetic
+     * keys and the handling of equal elements follow
+     * my::sort, a long series of bad pivots makes
+     * the rest of the range sequential
+     *
+     *   Time Complexity: O(nlogn), O(n) span
+     * Memory Complexity: O(logn)
+     */
+    template <typename Iterator, typename Compare, typename Projection>
+    void parallel_quick_sort(
+        executor & pool,
+        Iterator left,
+        Iterator right,
+        Compare & compare,
+        Projection & projection,
+        int bad_allowed,
+        bool leftmost
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        constexpr bool branchless =
+            is_branchless_comparison<T, Compare>() &&
+            std::is_same<Projection, identity>::value;
+
+        projected_compare<Compare &, Projection &> less { compare, projection };
+        task_group group;
+
+        while (right - left > PARALLEL_SORT_CUTOFF && bad_allowed > 0) {
+            size_t size = right - left;
+            size_t half = size / 2;
+
+            sort3(left, left + half, right - 1, less);
+            sort3(left + 1, left + (half - 1), right - 2, less);
+            sort3(left + 2, left + (half + 1), right - 3, less);
+            sort3(left + (half - 1), left + half, left + (half + 1), less);
+            std::iter_swap(left, left + half);
+
+            // the pivot equals the element before
+            // the range, skip all elements equal to it
+            if (!leftmost && !less(*(left - 1), *left)) {
+                left = sort_partition_left(left, right, less) + 1;
+                continue;
+            }
+
+            Iterator pivot = branchless
+                ? sort_partition_right_branchless(left, right, less).first
+                : sort_partition_right(left, right, less).first;
+
+            size_t left_size = pivot - left;
+            size_t right_size = right - (pivot + 1);
+
+            if (left_size < size / 8 || right_size < size / 8) {
+                bad_allowed--;
+            }
+
+            pool.spawn(group, [&pool, left, pivot, &compare, &projection, bad_allowed, leftmost] {
+                parallel_quick_sort(pool, left, pivot, compare, projection, bad_allowed, leftmost);
+            });
+
+            left = pivot + 1;
+            leftmost = false;
+        }
+
+        my::sort(left, right, compare, projection);
+        pool.sync(group);
+    }
+
+    /**
+     * Parallel sample sort in the spirit of IPS4o.
+     * Picks 2^SAMPLE_SORT_LOG_BUCKETS - 1 splitters
+     * from a sorted sample and stores them as an
+     * implicit search tree, so that each element finds
+     * its bucket with a fixed count of comparisons and
+     * no branches. Elements equal to a splitter get a
+     * bucket of their own that needs no sorting, so
+     * many equal keys make the sort faster, not slower.
+     *
+     * Stripes of the range are classified in parallel,
+     * then each stripe moves its elements into a buffer
+     * at precomputed offsets and every bucket is moved
+     * back and sorted by its own task. Unlike IPS4o
+     * the distribution is not in place: it takes
+     * a buffer of n elements and n bytes of bucket ids
+     *
+     *   Time Complexity: O(nlogn), O(n / p + logn) span
+     * Memory Complexity: O(n)
+     */
+    template <typename Iterator, typename Compare, typename Projection>
+    void sample_sort(
+        executor & pool,
+        Iterator left,
+        Iterator right,
+        Compare & compare,
+        Projection & projection
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        constexpr size_t buckets = size_t(1) << SAMPLE_SORT_LOG_BUCKETS;
+        constexpr size_t ids = 2 * buckets;
+
+        projected_compare<Compare &, Projection &> less { compare, projection };
+        size_t size = right - left;
+
+        // move a random sample to the front
+        size_t sample_size = buckets * SAMPLE_SORT_OVERSAMPLING;
+        uint64_t state = 0x9E3779B97F4A7C15ull ^ size;
+
+        for (size_t it = 0; it < sample_size; it++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            std::iter_swap(left + it, left + it + state % (size - it));
+        }
+
+        my::sort(left, left + sample_size, compare, projection);
+
+        // distinct splitters padded with the
+        // last one up to a complete search tree
+        std::vector<T> splitters;
+
+        for (size_t it = SAMPLE_SORT_OVERSAMPLING - 1; it < sample_size - 1; it += SAMPLE_SORT_OVERSAMPLING) {
+            if (splitters.empty() || less(splitters.back(), left[it])) {
+                splitters.push_back(left[it]);
+            }
+        }
+
+        while (splitters.size() < buckets - 1) {
+            splitters.push_back(splitters.back());
+        }
+
+        // tree[1] is the root, node i owns 2i and 2i + 1
+        std::vector<T> tree;
+        tree.reserve(buckets);
+        tree.push_back(splitters[0]);
+
+        for (size_t level = 0; level < SAMPLE_SORT_LOG_BUCKETS; level++) {
+            size_t step = buckets >> level;
+
+            for (size_t it = step / 2 - 1; it < buckets - 1; it += step) {
+                tree.push_back(splitters[it]);
+            }
+        }
+
+        auto classify = [&](const T & item) -> uint8_t {
+            size_t node = 1;
+
+            for (size_t level = 0; level < SAMPLE_SORT_LOG_BUCKETS; level++) {
+                node = 2 * node + less(tree[node], item);
+            }
+
+            size_t bucket = node - buckets;
+            bool equal = bucket < buckets - 1 && !less(item, splitters[bucket]);
+
+            return static_cast<uint8_t>(2 * bucket + equal);
+        };
+
+        // about 4 stripes per thread
+        size_t stripes = pool.thread_count() * 4;
+        size_t stripe = (size + stripes - 1) / stripes;
+        stripes = (size + stripe - 1) / stripe;
+
+        std::unique_ptr<uint8_t[]> bucket_of(new uint8_t[size]);
+        std::vector<size_t> offsets(stripes * ids, 0);
+
+        parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+            size_t * counts = &offsets[it * ids];
+            size_t end = (it + 1) * stripe < size ? (it + 1) * stripe : size;
+
+            for (size_t that = it * stripe; that < end; that++) {
+                uint8_t id = classify(left[that]);
+                bucket_of[that] = id;
+                counts[id]++;
+            }
+        }, 1);
+
+        // buckets go one after another, inside
+        // a bucket the stripes keep their order
+        std::vector<size_t> starts(ids + 1, 0);
+        size_t total = 0;
+
+        for (size_t id = 0; id < ids; id++) {
+            starts[id] = total;
+
+            for (size_t it = 0; it < stripes; it++) {
+                size_t count = offsets[it * ids + id];
+                offsets[it * ids + id] = total;
+                total += count;
+            }
+        }
+
+        starts[ids] = total;
+
+        // where every stripe starts every id, to know
+        // which elements were constructed on a throw
+        std::vector<size_t> firsts(offsets);
+        std::vector<uint8_t> released(ids, 0);
+
+        std::allocator<T> allocator;
+        T * buffer = allocator.allocate(size);
+        bool scattered = false;
+
+        try {
+            parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+                size_t * places = &offsets[it * ids];
+                size_t end = (it + 1) * stripe < size ? (it + 1) * stripe : size;
+
+                for (size_t that = it * stripe; that < end; that++) {
+                    new (buffer + places[bucket_of[that]]) T(std::move(left[that]));
+                    places[bucket_of[that]]++;
+                }
+            }, 1);
+
+            scattered = true;
+            task_group group;
+
+            for (size_t id = 0; id < ids; id++) {
+                size_t start = starts[id];
+                size_t end = starts[id + 1];
+
+                if (start == end)
+                    continue;
+
+                pool.spawn(group, [&, id, start, end] {
+                    std::move(buffer + start, buffer + end, left + start);
+                    std::destroy(buffer + start, buffer + end);
+                    released[id] = 1;
+
+                    // equality buckets are sorted already
+                    if (id % 2 == 1)
+                        return;
+
+                    // the previous bucket may be still
+                    // moving, so the range is leftmost
+                    if (end - start > PARALLEL_SORT_CUTOFF) {
+                        parallel_quick_sort(pool, left + start, left + end, compare, projection, bit_width(end - start), true);
+                    } else {
+                        my::sort(left + start, left + end, compare, projection);
+                    }
+                });
+            }
+
+            pool.sync(group);
+        } catch (...) {
+            for (size_t id = 0; id < ids; id++) {
+                if (scattered) {
+                    if (!released[id]) {
+                        std::destroy(buffer + starts[id], buffer + starts[id + 1]);
+                    }
+
+                    continue;
+                }
+
+                for (size_t it = 0; it < stripes; it++) {
+                    std::destroy(buffer + firsts[it * ids + id], buffer + offsets[it * ids + id]);
+                }
+            }
+
+            allocator.deallocate(buffer, size);
+            throw;
+        }
+
+        allocator.deallocate(buffer, size);
+    }
+
+    /**
+     * Parallel my::sort. Short ranges are sorted
+     * sequentially, long ones are distributed by
+     * sample_sort on pools of at least
+     * SAMPLE_SORT_MIN_THREADS threads and the rest
+     * by parallel_quick_sort. Not stable
+     *
+     *   Time Complexity: O(nlogn), n = right - left
+     * Memory Complexity: O(n)
+     */
+    template <
+        typename Iterator,
+        typename Compare = std::less<>,
+        typename Projection = identity
+    >
+    void sort(
+        const parallel_policy & policy,
+        Iterator left,
+        Iterator right,
+        Compare compare = Compare(),
+        Projection projection = Projection()
+    ) {
+        executor & pool = policy.get();
+        size_t size = std::distance(left, right);
+
+        if (pool.thread_count() == 1 || size <= PARALLEL_SORT_CUTOFF) {
+            my::sort(left, right, compare, projection);
+        } else if (size < SAMPLE_SORT_THRESHOLD || pool.thread_count() < SAMPLE_SORT_MIN_THREADS) {
+            parallel_quick_sort(pool, left, right, compare, projection, bit_width(size), true);
+        } else {
+            sample_sort(pool, left, right, compare, projection);
+        }
+    }
+
+    /**
+     * Returns the bytes of the staging area of
+     * radix_scatter_combining for mask + 1 digit
+     * values: a cache line per value followed
+     * by two counters per value
+     */
+    constexpr size_t radix_staging_size(size_t mask) noexcept {
+        size_t bytes = (mask + 1) * (EXECUTOR_CACHE_LINE + 2);
+        return (bytes + EXECUTOR_CACHE_LINE - 1) / EXECUTOR_CACHE_LINE * EXECUTOR_CACHE_LINE;
+    }
+
+    /**
+     * Moves the elements of [from, from + size) to
+     * to, ordered by the digit at shift, through a
+     * cache line of lines per digit value. Lines must
+     * be aligned to EXECUTOR_CACHE_LINE and hold
+     * radix_staging_size(mask) bytes. A line is
+     * flushed once it reaches a line boundary of
+     * the target, so the scattered writes fill whole
+     * cache lines of pointer targets and touch few
+     * pages at a time. Only for trivially copyable T,
+     * whose elements may be assigned to uninitialized
+     * memory
+     */
+    template <typename Source, typename Target, typename KeyOf>
+    void radix_scatter_combining(
+        Source from,
+        size_t size,
+        Target to,
+        size_t * offsets,
+        int shift,
+        size_t mask,
+        unsigned char * lines,
+        KeyOf & key
+    ) {
+        using T = typename std::iterator_traits<Source>::value_type;
+
+        constexpr size_t line = EXECUTOR_CACHE_LINE / sizeof(T);
+
+        // where the elements of every line start and end
+        uint8_t * first = lines + (mask + 1) * EXECUTOR_CACHE_LINE;
+        uint8_t * fill = first + mask + 1;
+
+        // the position in its cache line of the first target
+        size_t skew = 0;
+
+        if constexpr (std::is_pointer<Target>::value) {
+            skew = reinterpret_cast<uintptr_t>(to) % EXECUTOR_CACHE_LINE / sizeof(T);
+        }
+
+        for (size_t digit = 0; digit <= mask; digit++) {
+            first[digit] = fill[digit] = (skew + offsets[digit]) % line;
+        }
+
+        for (size_t it = 0; it < size; it++, ++from) {
+            size_t digit = (radix_key(std::invoke(key, *from)) >> shift) & mask;
+            T * place = reinterpret_cast<T *>(lines + digit * EXECUTOR_CACHE_LINE);
+
+            place[fill[digit]++] = *from;
+
+            if (fill[digit] == line) {
+                std::copy(place + first[digit], place + line, to + offsets[digit]);
+                offsets[digit] += line - first[digit];
+                first[digit] = fill[digit] = 0;
+            }
+        }
+
+        for (size_t digit = 0; digit <= mask; digit++) {
+            T * place = reinterpret_cast<T *>(lines + digit * EXECUTOR_CACHE_LINE);
+            std::copy(place + first[digit], place + fill[digit], to + offsets[digit]);
+            offsets[digit] += fill[digit] - first[digit];
+        }
+    }
+
+    /**
+     * Parallel LSD radix sort over a buffer, which
+     * must be uninitialized storage for n elements.
+     * The range is cut into stripes. A single parallel
+     * read counts the digits of all passes to skip the
+     * passes where all keys share the digit. Each pass
+     * then counts the digits of every stripe, computes
+     * where every stripe writes every digit value with
+     * a scan across the stripes for each digit value
+     * in parallel, and scatters the stripes at once.
+     * Small trivially copyable elements are scattered
+     * through write-combining lines, allocated once
+     * for each of at most p tasks that take the
+     * stripes in turn. Stable
+     *
+     *   Time Complexity: O(wn / d), O(wn / pd + w2^d) span, d = PARALLEL_RADIX_SORT_DIGIT_BITS
+     * Memory Complexity: O(p2^d)
+     */
+    template <typename Iterator, typename KeyOf>
+    void parallel_radix_sort(
+        executor & pool,
+        Iterator left,
+        Iterator right,
+        typename std::iterator_traits<Iterator>::value_type * buffer,
+        KeyOf & key
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+        using Key = decltype(radix_key(std::invoke(key, *left)));
+
+        constexpr int bits = 8 * sizeof(Key);
+        constexpr int digit_bits = bits <= 16 ? RADIX_SORT_SMALL_DIGIT_BITS : PARALLEL_RADIX_SORT_DIGIT_BITS;
+        constexpr int passes = (bits + digit_bits - 1) / digit_bits;
+        constexpr size_t buckets = size_t(1) << digit_bits;
+        constexpr size_t mask = buckets - 1;
+
+        constexpr bool combining =
+            std::is_trivially_copyable<T>::value &&
+            sizeof(T) * 2 <= EXECUTOR_CACHE_LINE;
+
+        size_t size = right - left;
+
+        // about 4 stripes per thread
+        size_t stripes = pool.thread_count() * 4;
+        size_t stripe = (size + stripes - 1) / stripes;
+        stripes = (size + stripe - 1) / stripe;
+
+        auto stripe_size = [&](size_t it) {
+            return (it + 1) * stripe < size ? stripe : size - it * stripe;
+        };
+
+        // the digits of all passes
+        std::vector<size_t> totals(stripes * passes * buckets, 0);
+
+        parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+            size_t * counts = &totals[it * passes * buckets];
+            Iterator from = left + it * stripe;
+
+            for (size_t that = stripe_size(it); that > 0; that--, ++from) {
+                Key bits_of = radix_key(std::invoke(key, *from));
+
+                for (int pass = 0; pass < passes; pass++) {
+                    counts[pass * buckets + ((bits_of >> (pass * digit_bits)) & mask)]++;
+                }
+            }
+        }, 1);
+
+        for (size_t it = 1; it < stripes; it++) {
+            for (size_t that = 0; that < passes * buckets; that++) {
+                totals[that] += totals[it * passes * buckets + that];
+            }
+        }
+
+        Key first = radix_key(std::invoke(key, *left));
+        std::vector<size_t> offsets(stripes * buckets);
+        bool in_buffer = false;
+        bool constructed = false;
+
+        // the staging lines of every task, allocated once
+        // for all passes and never initialized as a whole
+        constexpr size_t staging = radix_staging_size(mask);
+        size_t workers = pool.thread_count() < stripes ? pool.thread_count() : stripes;
+
+        auto release = [](unsigned char * lines) {
+            ::operator delete(lines, std::align_val_t(EXECUTOR_CACHE_LINE));
+        };
+
+        std::unique_ptr<unsigned char, decltype(release)> lines(nullptr, release);
+
+        if constexpr (combining) {
+            lines.reset(static_cast<unsigned char *>(
+                ::operator new(workers * staging, std::align_val_t(EXECUTOR_CACHE_LINE))
+            ));
+        }
+
+        for (int pass = 0; pass < passes; pass++) {
+            size_t * total = &totals[pass * buckets];
+            int shift = pass * digit_bits;
+
+            // every key has the same digit
+            if (total[(first >> shift) & mask] == size)
+                continue;
+
+            std::fill(offsets.begin(), offsets.end(), 0);
+
+            parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+                size_t * counts = &offsets[it * buckets];
+                size_t start = it * stripe;
+                size_t count = stripe_size(it);
+
+                if (in_buffer) {
+                    for (size_t that = start; that < start + count; that++) {
+                        counts[(radix_key(std::invoke(key, buffer[that])) >> shift) & mask]++;
+                    }
+                } else {
+                    for (size_t that = start; that < start + count; that++) {
+                        counts[(radix_key(std::invoke(key, left[that])) >> shift) & mask]++;
+                    }
+                }
+            }, 1);
+
+            std::vector<size_t> starts(buckets, 0);
+
+            for (size_t digit = 1; digit < buckets; digit++) {
+                starts[digit] = starts[digit - 1] + total[digit - 1];
+            }
+
+            // the scan of every digit value
+            // across the stripes is independent
+            parallel_for(par(pool), size_t(0), buckets, [&](size_t digit) {
+                size_t place = starts[digit];
+
+                for (size_t it = 0; it < stripes; it++) {
+                    size_t count = offsets[it * buckets + digit];
+                    offsets[it * buckets + digit] = place;
+                    place += count;
+                }
+            }, 32);
+
+            if constexpr (combining) {
+                std::atomic<size_t> next(0);
+
+                // every task takes stripes until none are
+                // left and scatters them through its lines
+                parallel_for(par(pool), size_t(0), workers, [&](size_t worker) {
+                    unsigned char * own = lines.get() + worker * staging;
+
+                    for (size_t it = next++; it < stripes; it = next++) {
+                        size_t * places = &offsets[it * buckets];
+                        size_t start = it * stripe;
+                        size_t count = stripe_size(it);
+
+                        if (in_buffer) {
+                            radix_scatter_combining(buffer + start, count, left, places, shift, mask, own, key);
+                        } else {
+                            radix_scatter_combining(left + start, count, buffer, places, shift, mask, own, key);
+                        }
+                    }
+                }, 1);
+            } else {
+                parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+                    size_t * places = &offsets[it * buckets];
+                    size_t start = it * stripe;
+                    size_t count = stripe_size(it);
+
+                    if (in_buffer) {
+                        radix_scatter<false>(buffer + start, count, left, places, shift, mask, key);
+                    } else if (constructed) {
+                        radix_scatter<false>(left + start, count, buffer, places, shift, mask, key);
+                    } else {
+                        radix_scatter<true>(left + start, count, buffer, places, shift, mask, key);
+                    }
+                }, 1);
+            }
+
+            constructed = true;
+            in_buffer = !in_buffer;
+        }
+
+        if (in_buffer) {
+            parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+                std::move(buffer + it * stripe, buffer + it * stripe + stripe_size(it), left + it * stripe);
+            }, 1);
+        }
+
+        if (constructed) {
+            std::destroy(buffer, buffer + size);
+        }
+    }
+
+    /**
+     * Parallel my::radix_sort. Short ranges
+     * are sorted sequentially. Stable
+     *
+     *   Time Complexity: O(wn / d), w = key bits, d = PARALLEL_RADIX_SORT_DIGIT_BITS
+     * Memory Complexity: O(n),      n = right - left
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void radix_sort(
+        const parallel_policy & policy,
+        Iterator left,
+        Iterator right,
+        KeyOf key = KeyOf()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        executor & pool = policy.get();
+        size_t size = std::distance(left, right);
+
+        if (pool.thread_count() == 1 || size <= PARALLEL_SORT_CUTOFF) {
+            my::radix_sort(left, right, key);
+            return;
+        }
+
+        std::allocator<T> allocator;
+        T * buffer = allocator.allocate(size);
+
+        try {
+            parallel_radix_sort(pool, left, right, buffer, key);
+        } catch (...) {
+            allocator.deallocate(buffer, size);
+            throw;
+        }
+
+        allocator.deallocate(buffer, size);
+    }
+
+    /**
+     * Parallel my::counting_histogram. Every
+     * thread counts its stripe into counters of
+     * its own, which are added up at the end
+     *
+     *   Time Complexity: O(n + pk), O(n / p + pk) span, k = limit
+     * Memory Complexity: O(pk)
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void counting_histogram(
+        const parallel_policy & policy,
+        Iterator left,
+        Iterator right,
+        size_t limit,
+        size_t * counts,
+        KeyOf key = KeyOf()
+    ) {
+        executor & pool = policy.get();
+        size_t size = std::distance(left, right);
+
+        if (pool.thread_count() == 1 || size <= PARALLEL_SORT_CUTOFF) {
+            my::counting_histogram(left, right, counts, key);
+            return;
+        }
+
+        size_t stripes = pool.thread_count();
+        size_t stripe = (size + stripes - 1) / stripes;
+        std::vector<size_t> partials(stripes * limit, 0);
+
+        parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+            size_t end = (it + 1) * stripe < size ? (it + 1) * stripe : size;
+            my::counting_histogram(left + it * stripe, left + end, &partials[it * limit], key);
+        }, 1);
+
+        parallel_for(par(pool), size_t(0), limit, [&](size_t value) {
+            for (size_t it = 0; it < stripes; it++) {
+                counts[value] += partials[it * limit + value];
+            }
+        });
+    }
+
+    /**
+     * Parallel my::counting_sort. Every thread
+     * counts its stripe, the starts of every key
+     * in every stripe are found in parallel over
+     * the keys, then the stripes are scattered
+     * at once. Plain integers are rewritten
+     * from the counts. Stable
+     *
+     *   Time Complexity: O(n + pk), O(n / p + pk) span, k = limit
+     * Memory Complexity: O(n + pk)
+     */
+    template <typename Iterator, typename KeyOf = identity>
+    void counting_sort(
+        const parallel_policy & policy,
+        Iterator left,
+        Iterator right,
+        size_t limit,
+        KeyOf key = KeyOf()
+    ) {
+        using T = typename std::iterator_traits<Iterator>::value_type;
+
+        executor & pool = policy.get();
+        size_t size = std::distance(left, right);
+
+        if (pool.thread_count() == 1 || size <= PARALLEL_SORT_CUTOFF) {
+            my::counting_sort(left, right, limit, key);
+            return;
+        }
+
+        if constexpr (std::is_integral<T>::value && std::is_same<KeyOf, identity>::value) {
+            std::vector<size_t> starts(limit + 1, 0);
+            counting_histogram(policy, left, right, limit, starts.data());
+            counting_offsets(starts.data(), limit + 1);
+
+            parallel_for(par(pool), size_t(0), limit, [&](size_t value) {
+                std::fill(left + starts[value], left + starts[value + 1], static_cast<T>(value));
+            });
+        } else {
+            size_t stripes = pool.thread_count();
+            size_t stripe = (size + stripes - 1) / stripes;
+            std::vector<size_t> offsets(stripes * limit, 0);
+
+            auto stripe_end = [&](size_t it) {
+                return (it + 1) * stripe < size ? (it + 1) * stripe : size;
+            };
+
+            parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+                my::counting_histogram(left + it * stripe, left + stripe_end(it), &offsets[it * limit], key);
+            }, 1);
+
+            // the keys go one after another, inside
+            // a key the stripes keep their order
+            std::vector<size_t> starts(limit, 0);
+
+            for (size_t value = 0; value < limit; value++) {
+                for (size_t it = 0; it < stripes; it++) {
+                    starts[value] += offsets[it * limit + value];
+                }
+            }
+
+            counting_offsets(starts.data(), limit);
+
+            parallel_for(par(pool), size_t(0), limit, [&](size_t value) {
+                size_t place = starts[value];
+
+                for (size_t it = 0; it < stripes; it++) {
+                    size_t count = offsets[it * limit + value];
+                    offsets[it * limit + value] = place;
+                    place += count;
+                }
+            });
+
+            // where every stripe starts every key, to know
+            // which elements were constructed on a throw
+            std::vector<size_t> firsts(offsets);
+            std::vector<uint8_t> released(stripes, 0);
+
+            std::allocator<T> allocator;
+            T * buffer = allocator.allocate(size);
+            bool scattered = false;
+
+            try {
+                parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+                    size_t * places = &offsets[it * limit];
+
+                    for (size_t that = it * stripe; that < stripe_end(it); that++) {
+                        size_t & place = places[static_cast<size_t>(std::invoke(key, left[that]))];
+                        new (buffer + place) T(std::move(left[that]));
+                        place++;
+                    }
+                }, 1);
+
+                scattered = true;
+
+                parallel_for(par(pool), size_t(0), stripes, [&](size_t it) {
+                    std::move(buffer + it * stripe, buffer + stripe_end(it), left + it * stripe);
+                    std::destroy(buffer + it * stripe, buffer + stripe_end(it));
+                    released[it] = 1;
+                }, 1);
+            } catch (...) {
+                for (size_t it = 0; it < stripes; it++) {
+                    if (scattered) {
+                        if (!released[it]) {
+                            std::destroy(buffer + it * stripe, buffer + stripe_end(it));
+                        }
+
+                        continue;
+                    }
+
+                    for (size_t value = 0; value < limit; value++) {
+                        std::destroy(buffer + firsts[it * limit + value], buffer + offsets[it * limit + value]);
+                    }
+                }
+
+                allocator.deallocate(buffer, size);
+                throw;
+            }
+
+            allocator.deallocate(buffer, size);
+        }
+    }
+}
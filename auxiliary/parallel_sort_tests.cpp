@@ -0,0 +1,363 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+// for random
+#include <cstdlib>
+// for the reference std::sort
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "parallel_sort.h"
+
+
+std::vector<int> make_pattern(int pattern, int size) {
+    std::vector<int> numbers;
+
+    for (int it = 0; it < size; it++) {
+        switch (pattern) {
+            case 0: numbers.push_back(rand()); break;
+            case 1: numbers.push_back(it); break;
+            case 2: numbers.push_back(size - it); break;
+            case 3: numbers.push_back(42); break;
+            case 4: numbers.push_back(rand() % 4); break;
+            default: numbers.push_back(it < size / 2 ? it : size - it); break;
+        }
+    }
+
+    return numbers;
+}
+
+
+TEST(parallel_sort_tests, patterns) {
+    for (size_t threads : {1, 2, 4}) {
+        my::executor pool(threads);
+
+        for (int pattern = 0; pattern < 6; pattern++) {
+            // sequential, parallel quick sort and sample sort
+            for (int size : {1000, 100000, 600000}) {
+                auto numbers = make_pattern(pattern, size);
+                auto expected = numbers;
+                std::sort(expected.begin(), expected.end());
+
+                my::sort(my::par(pool), numbers.begin(), numbers.end());
+                ASSERT_TRUE(numbers == expected);
+            }
+        }
+    }
+}
+
+
+TEST(parallel_sort_tests, compare_and_projection) {
+    my::executor pool(4);
+
+    std::vector<std::pair<int, std::string>> items;
+
+    for (int it = 0; it < 300000; it++) {
+        items.emplace_back(rand() % 100000, std::to_string(it));
+    }
+
+    my::sort(my::par(pool), items.begin(), items.end(), std::greater<>(), &std::pair<int, std::string>::first);
+
+    for (size_t it = 1; it < items.size(); it++) {
+        ASSERT_GE(items[it - 1].first, items[it].first);
+    }
+}
+
+
+/**
+ * String whose moves throw once the
+ * shared countdown reaches zero
+ */
+struct fragile {
+    static std::atomic<long> countdown;
+
+    std::string value;
+
+    fragile(std::string value) : value(std::move(value)) {}
+    fragile(const fragile & other) = default;
+    fragile & operator = (const fragile & other) = default;
+
+    fragile(fragile && other) : value(std::move(other.value)) {
+        if (--countdown == 0)
+            throw std::runtime_error("move");
+    }
+
+    fragile & operator = (fragile && other) {
+        if (--countdown == 0)
+            throw std::runtime_error("move");
+
+        value = std::move(other.value);
+        return *this;
+    }
+};
+
+std::atomic<long> fragile::countdown(0);
+
+
+TEST(parallel_sort_tests, sample_sort_exceptions) {
+    my::executor pool(4);
+
+    // throws while classifying, sorting the buckets
+    // and moving the elements into the buffer
+    for (long comparisons : {100000L, 6000000L, 0L}) {
+        for (long moves : {0L, 400000L}) {
+            if ((comparisons == 0) == (moves == 0))
+                continue;
+
+            std::vector<fragile> items;
+
+            for (int it = 0; it < 600000; it++) {
+                items.emplace_back(std::to_string(rand()));
+            }
+
+            std::atomic<long> left(comparisons);
+            auto compare = [&](const fragile & first, const fragile & second) {
+                if (--left == 0)
+                    throw std::runtime_error("compare");
+
+                return first.value < second.value;
+            };
+
+            fragile::countdown = moves;
+            ASSERT_THROW(my::sort(my::par(pool), items.begin(), items.end(), compare), std::runtime_error);
+            fragile::countdown = 0;
+        }
+    }
+}
+
+
+TEST(parallel_sort_tests, global_executor) {
+    auto numbers = make_pattern(0, 300000);
+    auto expected = numbers;
+    std::sort(expected.begin(), expected.end());
+
+    my::sort(my::par, numbers.begin(), numbers.end());
+    ASSERT_TRUE(numbers == expected);
+}
+
+
+TEST(parallel_sort_tests, radix_sort) {
+    // 1, 2, 4, ... and then all cores
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+
+    for (size_t threads = 1; threads < cores; threads *= 2) {
+        counts.push_back(threads);
+    }
+
+    counts.push_back(cores);
+
+    for (size_t threads : counts) {
+        my::executor pool(threads);
+
+        for (int pattern = 0; pattern < 6; pattern++) {
+            for (int size : {1000, 100000, 600000}) {
+                auto numbers = make_pattern(pattern, size);
+
+                for (auto it = numbers.begin(); it != numbers.end(); it++) {
+                    *it -= size / 2;
+                }
+
+                auto expected = numbers;
+                std::sort(expected.begin(), expected.end());
+
+                my::radix_sort(my::par(pool), numbers.begin(), numbers.end());
+                ASSERT_TRUE(numbers == expected);
+            }
+        }
+
+        std::vector<double> doubles;
+
+        for (int it = 0; it < 200000; it++) {
+            doubles.push_back((rand() - RAND_MAX / 2) / 7.0);
+        }
+
+        auto expected = doubles;
+        std::sort(expected.begin(), expected.end());
+
+        my::radix_sort(my::par(pool), doubles.begin(), doubles.end());
+        ASSERT_TRUE(doubles == expected);
+    }
+}
+
+
+/**
+ * Trivially copyable record of 12 bytes,
+ * which does not divide a cache line
+ */
+struct record {
+    short key;
+    int value;
+    int padding;
+
+    bool operator == (const record & other) const {
+        return key == other.key && value == other.value;
+    }
+};
+
+
+TEST(parallel_sort_tests, radix_sort_records) {
+    my::executor pool(3);
+
+    // trivially copyable ones go through the
+    // write-combining buffers, others do not
+    std::vector<record> small;
+    std::vector<std::pair<int, std::string>> large;
+
+    for (int it = 0; it < 300000; it++) {
+        small.push_back({ short(rand() % 1000 - 500), it, 0 });
+        large.emplace_back(rand() % 100000, std::to_string(it));
+    }
+
+    auto by_key = [](auto & first, auto & second) {
+        return first.key < second.key;
+    };
+
+    auto by_first = [](auto & first, auto & second) {
+        return first.first < second.first;
+    };
+
+    auto expected_small = small;
+    std::stable_sort(expected_small.begin(), expected_small.end(), by_key);
+    my::radix_sort(my::par(pool), small.begin(), small.end(), &record::key);
+    ASSERT_TRUE(small == expected_small);
+
+    auto expected_large = large;
+    std::stable_sort(expected_large.begin(), expected_large.end(), by_first);
+    my::radix_sort(my::par(pool), large.begin(), large.end(), &std::pair<int, std::string>::first);
+    ASSERT_TRUE(large == expected_large);
+}
+
+
+TEST(parallel_sort_tests, counting_sort) {
+    // 1, 2, 4, ... and then all cores
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+
+    for (size_t threads = 1; threads < cores; threads *= 2) {
+        counts.push_back(threads);
+    }
+
+    counts.push_back(cores);
+
+    for (size_t threads : counts) {
+        my::executor pool(threads);
+
+        std::vector<uint16_t> numbers;
+        std::vector<std::pair<int, std::string>> records;
+
+        for (int it = 0; it < 300000; it++) {
+            numbers.push_back(rand() % 5000);
+            records.emplace_back(rand() % 1000, std::to_string(it));
+        }
+
+        std::vector<size_t> counts(5000, 0);
+        my::counting_histogram(my::par(pool), numbers.begin(), numbers.end(), 5000, counts.data());
+
+        auto expected_numbers = numbers;
+        std::sort(expected_numbers.begin(), expected_numbers.end());
+
+        for (size_t value = 0; value < 5000; value++) {
+            auto range = std::equal_range(expected_numbers.begin(), expected_numbers.end(), value);
+            ASSERT_EQ(counts[value], size_t(range.second - range.first));
+        }
+
+        my::counting_sort(my::par(pool), numbers.begin(), numbers.end(), 5000);
+        ASSERT_TRUE(numbers == expected_numbers);
+
+        auto expected_records = records;
+        std::stable_sort(expected_records.begin(), expected_records.end(), [](auto & first, auto & second) {
+            return first.first < second.first;
+        });
+
+        my::counting_sort(my::par(pool), records.begin(), records.end(), 1000, &std::pair<int, std::string>::first);
+        ASSERT_TRUE(records == expected_records);
+    }
+}
+
+
+TEST(parallel_sort_tests, counting_sort_exceptions) {
+    my::executor pool(4);
+    const long size = 100000;
+
+    // the histogram takes the first n keys and the
+    // scatter the first n moves: throws while
+    // scattering and while moving back
+    for (long keys : {size + size / 2, 0L}) {
+        std::vector<fragile> items;
+
+        for (long it = 0; it < size; it++) {
+            items.emplace_back(std::string(32 + rand() % 8, 'a'));
+        }
+
+        std::atomic<long> calls(keys);
+        auto key = [&](const fragile & item) {
+            if (--calls == 0)
+                throw std::runtime_error("key");
+
+            return item.value.size() - 32;
+        };
+
+        fragile::countdown = keys == 0 ? size + size / 2 : 0;
+        ASSERT_THROW(my::counting_sort(my::par(pool), items.begin(), items.end(), 8, key), std::runtime_error);
+        fragile::countdown = 0;
+    }
+}
+
+
+TEST(parallel_sort_tests, DISABLED_sample_sort_benchmark) {
+    auto numbers = make_pattern(0, 1 << 22);
+
+    auto measure = [&](auto sort) {
+        double best = 1e9;
+
+        for (int run = 0; run < 5; run++) {
+            auto copy = numbers;
+            auto start = std::chrono::steady_clock::now();
+            sort(copy);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+
+        return best;
+    };
+
+    std::cout << "sequential: " << measure([](auto & copy) {
+        my::sort(copy.begin(), copy.end());
+    }) << " ms" << std::endl;
+
+    std::less<> less;
+    my::identity identity;
+
+    // 1, 2, 4, ... and then all cores
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+
+    for (size_t threads = 1; threads < cores; threads *= 2) {
+        counts.push_back(threads);
+    }
+
+    counts.push_back(cores);
+
+    for (size_t threads : counts) {
+        my::executor pool(threads);
+
+        std::cout << threads << " threads, quick sort: " << measure([&](auto & copy) {
+            my::parallel_quick_sort(pool, copy.begin(), copy.end(), less, identity, my::bit_width(copy.size()), true);
+        }) << " ms, sample sort: " << measure([&](auto & copy) {
+            my::sample_sort(pool, copy.begin(), copy.end(), less, identity);
+        }) << " ms" << std::endl;
+    }
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <atomic>
+
+
+#include "parallel.h"
+
+
+TEST(parallel_tests, parallel_for) {
+    for (size_t threads : {1, 2, 4}) {
+        my::executor pool(threads);
+
+        for (size_t grain : {0, 1, 7, 1000}) {
+            std::vector<int> hits(10007, 0);
+
+            my::parallel_for(my::par(pool), 0, 10007, [&](int it) {
+                hits[it]++;
+            }, grain);
+
+            for (int it = 0; it < 10007; it++) {
+                ASSERT_EQ(hits[it], 1);
+            }
+        }
+
+        std::vector<int> items(1000, 1);
+
+        my::parallel_for(my::par(pool), items.begin(), items.end(), [](std::vector<int>::iterator it) {
+            *it *= 2;
+        });
+
+        for (auto it = items.begin(); it != items.end(); it++) {
+            ASSERT_EQ(*it, 2);
+        }
+
+        // an empty range does nothing
+        my::parallel_for(my::par(pool), 5, 5, [](int) {
+            throw std::runtime_error("called");
+        });
+    }
+}
+
+
+TEST(parallel_tests, parallel_reduce) {
+    for (size_t threads : {1, 3}) {
+        my::executor pool(threads);
+        std::vector<long> items(100000);
+
+        for (size_t it = 0; it < items.size(); it++) {
+            items[it] = it;
+        }
+
+        for (size_t grain : {0, 1, 333}) {
+            ASSERT_EQ(my::parallel_reduce(my::par(pool), items.begin(), items.end(), 5L, std::plus<>(), grain), 4999950005L);
+        }
+
+        // not commutative: the order is kept
+        std::vector<std::string> words;
+
+        for (int it = 0; it < 1000; it++) {
+            words.push_back(std::to_string(it % 10));
+        }
+
+        std::string expected = ">";
+
+        for (auto it = words.begin(); it != words.end(); it++) {
+            expected += *it;
+        }
+
+        ASSERT_EQ(my::parallel_reduce(my::par(pool), words.begin(), words.end(), std::string(">"), std::plus<>(), 3), expected);
+        ASSERT_EQ(my::parallel_reduce(my::par(pool), words.end(), words.end(), std::string(">")), ">");
+    }
+}
+
+
+TEST(parallel_tests, parallel_transform) {
+    my::executor pool(4);
+    std::vector<int> items(50000);
+
+    for (size_t it = 0; it < items.size(); it++) {
+        items[it] = it;
+    }
+
+    std::vector<long> squares(items.size());
+    auto end = my::parallel_transform(my::par(pool), items.begin(), items.end(), squares.begin(), [](int item) {
+        return long(item) * item;
+    }, 100);
+
+    ASSERT_TRUE(end == squares.end());
+
+    for (size_t it = 0; it < items.size(); it++) {
+        ASSERT_EQ(squares[it], long(it) * it);
+    }
+
+    // in place
+    my::parallel_transform(my::par(pool), items.begin(), items.end(), items.begin(), [](int item) {
+        return -item;
+    });
+
+    for (size_t it = 0; it < items.size(); it++) {
+        ASSERT_EQ(items[it], -int(it));
+    }
+}
+
+
+TEST(parallel_tests, parallel_invoke) {
+    my::executor pool(2);
+    std::atomic<int> calls { 0 };
+
+    my::parallel_invoke(my::par(pool),
+        [&] { calls += 1; },
+        [&] { calls += 10; },
+        [&] { calls += 100; }
+    );
+
+    ASSERT_EQ(calls.load(), 111);
+
+    ASSERT_THROW(my::parallel_invoke(my::par(pool),
+        [&] { calls += 1; },
+        [] { throw std::runtime_error("failed"); }
+    ), std::runtime_error);
+
+    ASSERT_EQ(calls.load(), 112);
+}
+
+
+TEST(parallel_tests, rethrows) {
+    my::executor pool(3);
+    std::atomic<int> calls { 0 };
+
+    ASSERT_THROW(my::parallel_for(my::par(pool), 0, 1000, [&](int it) {
+        calls++;
+
+        if (it == 500) {
+            throw std::runtime_error("failed");
+        }
+    }, 10), std::runtime_error);
+
+    ASSERT_GE(calls.load(), 10);
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// for std::FILE & std::remove
+#include <cstdio>
+// for std::string
+#include <string>
+// for mkstemp
+#include <stdlib.h>
+// for fdopen
+#include <stdio.h>
+// for close
+#include <unistd.h>
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Creates a new file with a unique name that
+     * starts with prefix in directory and opens it
+     * for reading and writing. Writes the name to path.
+     * The file is created exclusively (mkstemp), so an
+     * existing file or a planted link is never opened
+     * and overwritten. Returns nullptr on failure
+     */
+    inline std::FILE * create_temporary_file(
+        const std::string & directory,
+        const char * prefix,
+        std::string & path
+    ) {
+        path = directory + "/" + prefix + "XXXXXX";
+
+        int descriptor = mkstemp(&path[0]);
+
+        if (descriptor == -1) {
+            path.clear();
+            return nullptr;
+        }
+
+        std::FILE * result = fdopen(descriptor, "w+b");
+
+        if (result == nullptr) {
+            close(descriptor);
+            std::remove(path.c_str());
+            path.clear();
+        }
+
+        return result;
+    }
+}
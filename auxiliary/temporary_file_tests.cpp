@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "temporary_file.h"
+
+
+TEST(temporary_file_tests, creates_unique_files) {
+    std::string directory = ::testing::TempDir();
+    std::string first;
+    std::string second;
+
+    std::FILE * a = my::create_temporary_file(directory, "temporary_file_tests_", first);
+    std::FILE * b = my::create_temporary_file(directory, "temporary_file_tests_", second);
+
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_NE(first, second);
+    ASSERT_EQ(first.compare(0, directory.size(), directory), 0);
+
+    int number = 42;
+    ASSERT_EQ(std::fwrite(&number, sizeof(number), 1, a), 1);
+    std::rewind(a);
+    number = 0;
+    ASSERT_EQ(std::fread(&number, sizeof(number), 1, a), 1);
+    ASSERT_EQ(number, 42);
+
+    std::fclose(a);
+    std::fclose(b);
+    ASSERT_EQ(std::remove(first.c_str()), 0);
+    ASSERT_EQ(std::remove(second.c_str()), 0);
+}
+
+
+TEST(temporary_file_tests, missing_directory) {
+    std::string path = "unchanged";
+
+    ASSERT_EQ(my::create_temporary_file("/nonexistent/directory", "temporary_file_tests_", path), nullptr);
+    ASSERT_TRUE(path.empty());
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
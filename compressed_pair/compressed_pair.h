@@ -1,5 +1,10 @@
 #pragma once
 
+// for std::move
+#include <utility>
+// for std::is_class
+#include <type_traits>
+
 
 /**
  * Custom implementations
@@ -19,11 +24,20 @@ namespace my {
      * Use is_empty<T>::value to find out
      * if T is empty
      */
-    template <typename T>
+    template <typename T, bool IsClass = std::is_class<T>::value>
     struct is_empty {
         static const bool value = sizeof(not_empty_wrapper<T>) == sizeof(char);
     };
 
+    /**
+     * Non-class types (e.g. function pointers)
+     * can't be inherited from and are never empty
+     */
+    template <typename T>
+    struct is_empty<T, false> {
+        static const bool value = false;
+    };
+
 
     /**
      * Base will act as a set of particular
@@ -66,6 +80,13 @@ namespace my {
         compressed_pair_base(const T & first, const K & second)
             : the_first(first), the_second(second) {}
 
+        /**
+         * Instantiates first as copy
+         * and moves second
+         */
+        compressed_pair_base(const T & first, K && second)
+            : the_first(first), the_second(std::move(second)) {}
+
         /**
          * Instantiates first as copy
          */
@@ -145,6 +166,13 @@ namespace my {
         compressed_pair_base(const T & first, const K & second)
             : T(first), the_second(second) {}
 
+        /**
+         * Instantiates first as copy
+         * and moves second
+         */
+        compressed_pair_base(const T & first, K && second)
+            : T(first), the_second(std::move(second)) {}
+
         /**
          * Instantiates first as copy
          */
@@ -356,5 +384,7 @@ namespace my {
      * the proper implementation
      */
     template <typename T, typename K>
-    struct compressed_pair : compressed_pair_base<T, K, is_empty<T>::value, is_empty<K>::value> {};
+    struct compressed_pair : compressed_pair_base<T, K, is_empty<T>::value, is_empty<K>::value> {
+        using compressed_pair_base<T, K, is_empty<T>::value, is_empty<K>::value>::compressed_pair_base;
+    };
 }
\ No newline at end of file
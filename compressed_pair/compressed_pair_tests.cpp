@@ -17,6 +17,8 @@ TEST(compressed_pair_tests, empties) {
 
     ASSERT_FALSE(my::is_empty<NotEmpty>::value);
     ASSERT_TRUE (my::is_empty<Empty>::value == true);
+    ASSERT_FALSE(my::is_empty<int>::value);
+    ASSERT_FALSE(my::is_empty<bool (*) (int, int)>::value);
 }
 
 
@@ -16,6 +16,8 @@
 #include <cmath>
 // for std::is_same
 #include <type_traits>
+// for std::out_of_range & std::length_error
+#include <stdexcept>
 
 /**
  * Used by the default constructor
@@ -689,17 +691,19 @@ namespace my {
          * to satisfy the new capacity
          */
         void force_reserve(size_type new_capacity) {
-            size_type old_size = 0;
+            size_type old_size = the_end - the_begin;
 
             // allocate new space
             pointer new_place = allocator_traits::allocate(the_allocator, new_capacity);
 
             // if we had smth previously
-            if (the_begin != the_end) {
-                old_size = the_end - the_begin;
+            if (old_size != 0) {
                 // copy contents
                 std::memcpy(new_place, the_begin, sizeof(T) * old_size);
-                // deallocate old space
+            }
+
+            // deallocate old space, even if it is empty
+            if (the_begin != nullptr) {
                 allocator_traits::deallocate(the_allocator, the_begin, the_capacity);
             }
 
@@ -750,6 +754,8 @@ namespace my {
 
                 if (the_capacity > max / 2) {
                     force_reserve(max);
+                } else if (the_capacity == 0) {
+                    force_reserve(VECTOR_DEFAULT_CAPACITY);
                 } else {
                     force_reserve(the_capacity * 2);
                 }
@@ -776,9 +782,13 @@ namespace my {
                 } else {
                     // new capacity must be >= new_size
                     // so the_capacity * 2^power >= new_size
-                    size_type power = ceil(log2( new_size / the_capacity ));
-                    size_type new_capacity = the_capacity * pow(2, power);
-                    force_reserve(new_capacity);
+                    size_type new_capacity = the_capacity == 0 ? VECTOR_DEFAULT_CAPACITY : the_capacity;
+
+                    while (new_capacity < new_size && new_capacity <= max / 2) {
+                        new_capacity *= 2;
+                    }
+
+                    force_reserve(new_capacity < new_size ? max : new_capacity);
                 }
             }
         }
@@ -789,6 +789,18 @@ TEST(vector_tests, insert_n_custom_allocator) {
 }
 
 
+TEST(vector_tests, insert_n_grows) {
+    my::fast_vector<Snitch> balls(10, Snitch {15});
+    std::initializer_list list = { Snitch {16}, Snitch {17}, Snitch {20}, Snitch {21}, Snitch {36} };
+
+    balls.insert(balls.end(), list.begin(), list.end());
+
+    assert(balls.size()     == 15   );
+    assert(balls.capacity() >= 15   );
+    assert(balls.back()     == Snitch {36});
+}
+
+
 TEST(vector_tests, erase_one) {
     my::fast_vector<Snitch> balls = {
         Snitch {15}, Snitch {16}, Snitch {17}, Snitch {20}, Snitch {21}, Snitch {36}
@@ -853,6 +865,52 @@ TEST(vector_tests, erase_n_custom_allocator) {
 }
 
 
+/**
+ * Allocator that counts the
+ * blocks it has not freed yet
+ */
+template <typename T>
+struct counting_allocator : my::debug_allocator<T> {
+    static inline long outstanding = 0;
+
+    template <typename K>
+    struct rebind {
+        using other = counting_allocator<K>;
+    };
+
+    counting_allocator() {}
+
+    template <typename K>
+    counting_allocator(const counting_allocator<K> & other) {}
+
+    T * allocate(size_t size, const T * = 0) {
+        outstanding++;
+        return my::debug_allocator<T>::allocate(size);
+    }
+
+    void deallocate(T * location, size_t size = 0) {
+        outstanding--;
+        my::debug_allocator<T>::deallocate(location, size);
+    }
+};
+
+
+TEST(vector_tests, reserve_empty_releases) {
+    {
+        // the storage of an empty vector
+        // is freed when it grows again
+        my::fast_vector<int, counting_allocator<int>> numbers;
+        numbers.reserve(10);
+        numbers.reserve(100);
+        numbers.push_back(1);
+        numbers.pop_back();
+        numbers.reserve(1000);
+    }
+
+    assert(counting_allocator<int>::outstanding == 0);
+}
+
+
 int main(int argc, char * argv[]) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
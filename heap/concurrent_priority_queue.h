@@ -0,0 +1,370 @@
+#pragma once
+
+// for std::less
+#include <functional>
+// for std::atomic
+#include <atomic>
+// for std::thread::hardware_concurrency, std::this_thread::yield
+#include <thread>
+// for std::unique_ptr
+#include <memory>
+// for uint64_t
+#include <cstdint>
+
+#include "heap.h"
+
+
+/**
+ * Used to pad sub-queues so that
+ * they never share a cache line
+ */
+#define CONCURRENT_PRIORITY_QUEUE_CACHE_LINE 64
+
+/**
+ * Count of sub-queues per thread
+ */
+#define CONCURRENT_PRIORITY_QUEUE_DEFAULT_FACTOR 2
+
+/**
+ * Count of operations a thread performs on
+ * the same sub-queues before choosing new ones
+ */
+#define CONCURRENT_PRIORITY_QUEUE_STICKINESS 8
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Relaxed priority queue for many threads
+     * (MultiQueue). Consists of c * P sequential
+     * my::heap's each guarded by its own lock.
+     * push goes to a random sub-queue, pop takes the
+     * better top of two random sub-queues, so threads
+     * rarely contend for the same lock.
+     *
+     * Ordering follows my::heap: the element for which
+     * Compare returns false against any other is the best
+     * one. try_pop does not always return the best element:
+     * with two random choices over m = c * P sub-queues
+     * the expected rank of the returned element is O(m)
+     * and ranks much greater than m are exponentially
+     * unlikely. When both choices are empty try_pop
+     * visits the sub-queues one by one. try_pop_exact
+     * locks every sub-queue and returns the best element
+     * when that is required
+     */
+    template <
+        typename T,
+        typename Compare = std::less<T>
+    >
+    class concurrent_priority_queue {
+    public:
+        /**
+         * Allows to access template types.
+         * Despite these definitions exist I prefer
+         * using T and Compare.
+         */
+        using    value_type = T;
+        using value_compare = Compare;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using size_type = size_t;
+
+        /**
+         * Constructs factor * threads
+         * empty sub-queues
+         */
+        explicit concurrent_priority_queue(
+            size_type threads = std::thread::hardware_concurrency(),
+            size_type factor = CONCURRENT_PRIORITY_QUEUE_DEFAULT_FACTOR,
+            const Compare & comparison = Compare()
+        ) : the_comparison(comparison) {
+            the_queue_count = (threads == 0 ? 1 : threads) * (factor == 0 ? 1 : factor);
+            // a second sub-queue is needed to choose from
+            the_queue_count = the_queue_count < 2 ? 2 : the_queue_count;
+            the_queues.reset(new sub_queue[the_queue_count]);
+
+            for (size_type it = 0; it < the_queue_count; it++) {
+                the_queues[it].items = my::heap<T, Compare>(comparison);
+            }
+        }
+
+        /**
+         * Returns the count of sub-queues
+         */
+        size_type queue_count() const noexcept {
+            return the_queue_count;
+        }
+
+        /**
+         * Returns the count of elements.
+         * Only a snapshot if other
+         * threads are working
+         */
+        size_type size() const noexcept {
+            size_type result = 0;
+
+            for (size_type it = 0; it < the_queue_count; it++) {
+                result += the_queues[it].count.load(std::memory_order_relaxed);
+            }
+
+            return result;
+        }
+
+        /**
+         * Returns true if size is 0
+         */
+        bool empty() const noexcept {
+            for (size_type it = 0; it < the_queue_count; it++) {
+                if (the_queues[it].count.load(std::memory_order_relaxed) != 0)
+                    return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * Adds element to a random sub-queue
+         */
+        void push(const T & item) {
+            while (true) {
+                choice & sticky = choose();
+                auto & queue = the_queues[sticky.first];
+
+                if (queue.try_lock()) {
+                    queue.items.push(item);
+                    queue.update_count();
+                    queue.unlock();
+                    return;
+                }
+
+                sticky.uses = 0;
+            }
+        }
+
+        /**
+         * Removes one of the best elements
+         * and stores it in result. Returns false
+         * if the queue is empty
+         */
+        bool try_pop(T & result) {
+            for (size_type attempt = 0; attempt < the_queue_count; attempt++) {
+                choice & sticky = choose();
+
+                auto & first  = the_queues[sticky.first];
+                auto & second = the_queues[sticky.second];
+
+                if (!first.try_lock()) {
+                    sticky.uses = 0;
+                    continue;
+                }
+
+                if (!second.try_lock()) {
+                    first.unlock();
+                    sticky.uses = 0;
+                    continue;
+                }
+
+                auto * best = &first;
+
+                if (first.items.empty() || (!second.items.empty() && compare(first.items.top(), second.items.top()))) {
+                    best = &second;
+                }
+
+                bool found = !best->items.empty();
+
+                if (found) {
+                    take(*best, result);
+                }
+
+                second.unlock();
+                first.unlock();
+
+                if (found)
+                    return true;
+
+                // both are empty, so most of
+                // the others likely are too
+                sticky.uses = 0;
+                break;
+            }
+
+            return try_pop_any(result);
+        }
+
+        /**
+         * Removes the best element and stores it in
+         * result. Locks every sub-queue so that no other
+         * operation may run in the meantime.
+         * Returns false if the queue is empty
+         */
+        bool try_pop_exact(T & result) {
+            // always lock in the same order to avoid deadlocks
+            for (size_type it = 0; it < the_queue_count; it++) {
+                the_queues[it].lock();
+            }
+
+            sub_queue * best = nullptr;
+
+            for (size_type it = 0; it < the_queue_count; it++) {
+                auto & queue = the_queues[it];
+
+                if (!queue.items.empty() && (best == nullptr || compare(best->items.top(), queue.items.top()))) {
+                    best = &queue;
+                }
+            }
+
+            if (best != nullptr) {
+                take(*best, result);
+            }
+
+            for (size_type it = the_queue_count; it > 0; it--) {
+                the_queues[it - 1].unlock();
+            }
+
+            return best != nullptr;
+        }
+
+    private:
+        /**
+         * Sequential heap padded to its own cache
+         * lines. Guarded by a spin lock: every
+         * operation but try_pop_exact only tries
+         * to lock, so no thread ever sleeps on it
+         * and unlocking is a plain store
+         */
+        struct alignas(CONCURRENT_PRIORITY_QUEUE_CACHE_LINE) sub_queue {
+            std::atomic<bool> locked { false };
+            std::atomic<size_type> count { 0 };
+            my::heap<T, Compare> items;
+
+            bool try_lock() noexcept {
+                return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+            }
+
+            void lock() noexcept {
+                while (!try_lock()) {
+                    std::this_thread::yield();
+                }
+            }
+
+            void unlock() noexcept {
+                locked.store(false, std::memory_order_release);
+            }
+
+            /**
+             * Publishes the size for size() and empty()
+             * without a shared counter that every
+             * thread would have to modify
+             */
+            void update_count() noexcept {
+                count.store(items.size(), std::memory_order_relaxed);
+            }
+        };
+
+        Compare the_comparison;
+        std::unique_ptr<sub_queue[]> the_queues;
+        size_type the_queue_count;
+
+        /**
+         * Returns true if first must
+         * be placed below second
+         */
+        bool compare(const T & first, const T & second) const {
+            return the_comparison(first, second);
+        }
+
+        /**
+         * Moves the top of the locked
+         * sub-queue into result
+         */
+        void take(sub_queue & queue, T & result) {
+            result = std::move(queue.items.front());
+            queue.items.pop_top();
+            queue.update_count();
+        }
+
+        /**
+         * Takes the top of the first non-empty sub-queue
+         * starting from a random one. Holds one lock
+         * at a time, so unlike try_pop_exact it does not
+         * stop the other threads. Returns false if every
+         * sub-queue was empty when visited
+         */
+        bool try_pop_any(T & result) {
+            size_type start = random() % the_queue_count;
+
+            for (size_type it = 0; it < the_queue_count; it++) {
+                auto & queue = the_queues[(start + it) % the_queue_count];
+
+                if (queue.count.load(std::memory_order_relaxed) == 0)
+                    continue;
+
+                queue.lock();
+
+                bool found = !queue.items.empty();
+
+                if (found) {
+                    take(queue, result);
+                }
+
+                queue.unlock();
+
+                if (found)
+                    return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * Two distinct sub-queues a thread keeps
+         * using for a few operations in a row,
+         * so that their tops stay in its cache
+         */
+        struct choice {
+            const concurrent_priority_queue * owner = nullptr;
+            size_type first = 0;
+            size_type second = 0;
+            size_type uses = 0;
+        };
+
+        /**
+         * Returns the sub-queues of the calling
+         * thread, choosing new random ones once
+         * they were used often enough or failed
+         */
+        choice & choose() noexcept {
+            thread_local choice sticky;
+
+            if (sticky.owner != this || sticky.uses == 0) {
+                sticky.owner = this;
+                sticky.first = random() % the_queue_count;
+                sticky.second = (sticky.first + 1 + random() % (the_queue_count - 1)) % the_queue_count;
+                sticky.uses = CONCURRENT_PRIORITY_QUEUE_STICKINESS;
+            }
+
+            sticky.uses--;
+            return sticky;
+        }
+
+        /**
+         * Per-thread xorshift generator,
+         * cheap enough to call on every operation
+         */
+        static uint64_t random() noexcept {
+            static std::atomic<uint64_t> seeds { 0x9E3779B97F4A7C15ull };
+            thread_local uint64_t state = seeds.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed) | 1;
+
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            return state;
+        }
+    };
+}
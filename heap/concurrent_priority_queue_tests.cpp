@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+
+
+#include "concurrent_priority_queue.h"
+
+
+TEST(concurrent_priority_queue_tests, create_empty) {
+    my::concurrent_priority_queue<int> queue(4);
+    int result = 0;
+
+    ASSERT_EQ(queue.queue_count(), 8);
+    ASSERT_TRUE(queue.empty());
+    ASSERT_FALSE(queue.try_pop(result));
+    ASSERT_FALSE(queue.try_pop_exact(result));
+}
+
+
+TEST(concurrent_priority_queue_tests, exact_pops_sorted) {
+    my::concurrent_priority_queue<int, std::greater<int>> queue(4);
+
+    for (int it = 0; it < 1000; it++) {
+        queue.push(rand() % 100);
+    }
+
+    int previous = -1;
+    int result = 0;
+
+    while (queue.try_pop_exact(result)) {
+        ASSERT_LE(previous, result);
+        previous = result;
+    }
+
+    ASSERT_TRUE(queue.empty());
+}
+
+
+TEST(concurrent_priority_queue_tests, relaxed_pops_everything) {
+    constexpr int threads = 4;
+    constexpr int per_thread = 10000;
+
+    my::concurrent_priority_queue<int> queue(threads);
+    std::vector<std::thread> workers;
+    std::vector<std::vector<int>> popped(threads);
+
+    for (int it = 0; it < threads; it++) {
+        workers.emplace_back([&queue, &popped, it] {
+            for (int that = 0; that < per_thread; that++) {
+                queue.push(it * per_thread + that);
+
+                int result = 0;
+
+                if (that % 2 == 1 && queue.try_pop(result)) {
+                    popped[it].push_back(result);
+                }
+            }
+        });
+    }
+
+    for (auto & worker : workers) {
+        worker.join();
+    }
+
+    std::vector<int> all;
+    int result = 0;
+
+    while (queue.try_pop(result)) {
+        all.push_back(result);
+    }
+
+    for (auto & part : popped) {
+        all.insert(all.end(), part.begin(), part.end());
+    }
+
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), threads * per_thread);
+
+    for (int it = 0; it < threads * per_thread; it++) {
+        ASSERT_EQ(all[it], it);
+    }
+}
+
+
+/**
+ * Runs threads that together do count pushes and
+ * pops, alternating them after a prefill of the
+ * queue, and returns millions of operations per second
+ */
+template <typename Push, typename Pop>
+double measure_throughput(size_t threads, size_t count, Push push, Pop pop) {
+    size_t per_thread = count / threads;
+
+    for (size_t it = 0; it < per_thread; it++) {
+        push(int(it * 2654435761u % 1000003));
+    }
+
+    std::atomic<bool> go { false };
+    std::atomic<long long> sink { 0 };
+    std::vector<std::thread> workers;
+
+    for (size_t worker = 0; worker < threads; worker++) {
+        workers.emplace_back([&, worker] {
+            int result = 0;
+            long long sum = 0;
+
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            for (size_t it = 0; it < per_thread; it++) {
+                push(int((worker * per_thread + it) * 2654435761u % 1000003));
+                pop(result);
+                sum += result;
+            }
+
+            sink += sum;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+
+    for (auto & worker : workers) {
+        worker.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "(" << sink << ") ";
+
+    return 2 * per_thread * threads / elapsed.count() / 1e6;
+}
+
+
+TEST(concurrent_priority_queue_tests, DISABLED_scaling_benchmark) {
+    // threads beyond the cores show the cost of preemption
+    // while a thread holds a lock
+    constexpr size_t count = 2000000;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        my::concurrent_priority_queue<int> queue(threads);
+
+        std::mutex lock;
+        my::heap<int> heap;
+
+        double relaxed = measure_throughput(threads, count,
+            [&](int item) { queue.push(item); },
+            [&](int & result) { queue.try_pop(result); }
+        );
+
+        double guarded = measure_throughput(threads, count,
+            [&](int item) { std::lock_guard<std::mutex> guard(lock); heap.push(item); },
+            [&](int & result) { std::lock_guard<std::mutex> guard(lock); result = heap.top(); heap.pop_top(); }
+        );
+
+        std::cout << threads << " threads: relaxed " << relaxed << " Mops/s, single mutex " << guarded << " Mops/s" << std::endl;
+    }
+}
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,508 @@
+#pragma once
+
+// for std::less
+#include <functional>
+// for std::FILE
+#include <cstdio>
+// for std::runtime_error
+#include <stdexcept>
+// for std::string
+#include <string>
+// for std::vector
+#include <vector>
+// for std::is_trivially_copyable
+#include <type_traits>
+
+#include "../fast_vector/fast_vector.h"
+#include "../auxiliary/temporary_file.h"
+#include "heap.h"
+#include "loser_tree.h"
+
+
+/**
+ * Used by default as the memory budget
+ */
+#define EXTERNAL_HEAP_DEFAULT_MEMORY (64 << 20)
+
+/**
+ * Used by default as the size of
+ * a single read or write of a run
+ */
+#define EXTERNAL_HEAP_DEFAULT_BLOCK (1 << 20)
+
+/**
+ * The count of runs merged at once is chosen
+ * so that this many levels of runs fit into
+ * the memory budget for read blocks
+ */
+#define EXTERNAL_HEAP_LEVELS 4
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Priority queue that may hold more elements
+     * than fit into memory. New elements go to
+     * an in-memory my::heap. Once it fills half
+     * of the memory budget it is written out as
+     * a sorted run to a temporary file with large
+     * sequential writes. Runs are read back one
+     * block at a time and merged lazily on pop
+     * through a loser tree. Every spilled run is on
+     * level 0; once a level holds k runs they are
+     * merged into one run of the next level, so every
+     * element is rewritten O(log_k(n / M)) times. Only
+     * if the read blocks of the runs would still exceed
+     * the other half of the budget all runs are merged.
+     *
+     * Ordering follows my::heap: the element for
+     * which Compare returns false against any other
+     * is on top. T must be trivially copyable since
+     * it is written to files as is. Only the local
+     * filesystem is used: std::tmpfile by default
+     * or files in the given directory
+     */
+    template <
+        typename T,
+        typename Compare = std::less<T>
+    >
+    class external_heap {
+    public:
+        /**
+         * Allows to access template type T.
+         * Despite value_type is defined I prefer
+         * using T.
+         */
+        using value_type = T;
+
+        /**
+         * Allows to access comparator type.
+         * Despite value_compare is defined I prefer
+         * using Compare.
+         */
+        using value_compare = Compare;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using       size_type = size_t;
+        using const_reference = const value_type &;
+
+        static_assert(
+            std::is_trivially_copyable<T>::value,
+            "T must be trivially copyable"
+        );
+
+        /**
+         * Constructs an empty heap that keeps
+         * about memory bytes in memory and reads
+         * and writes runs by block bytes.
+         * Runs are created in directory if given
+         */
+        explicit external_heap(
+            size_type memory = EXTERNAL_HEAP_DEFAULT_MEMORY,
+            size_type block = EXTERNAL_HEAP_DEFAULT_BLOCK,
+            const char * directory = nullptr,
+            const Compare & comparison = Compare()
+        ) : the_comparison(comparison), the_inserted(comparison) {
+            the_block = block / sizeof(T) == 0 ? 1 : block / sizeof(T);
+            the_capacity = memory / 2 / sizeof(T);
+            the_capacity = the_capacity < the_block ? the_block : the_capacity;
+            the_max_runs = memory / 2 / (the_block * sizeof(T));
+            the_max_runs = the_max_runs < 2 ? 2 : the_max_runs;
+            the_fan_in = the_max_runs / EXTERNAL_HEAP_LEVELS;
+            the_fan_in = the_fan_in < 2 ? 2 : the_fan_in;
+
+            if (directory != nullptr) {
+                the_directory = directory;
+            }
+        }
+
+        /**
+         * Closes and removes all runs
+         */
+        ~external_heap() {
+            close_runs();
+        }
+
+        external_heap(const external_heap &) = delete;
+        void operator = (const external_heap &) = delete;
+
+        /**
+         * Returns the count of elements
+         */
+        size_type size() const noexcept {
+            return the_size;
+        }
+
+        /**
+         * Returns true if size is 0
+         */
+        bool empty() const noexcept {
+            return the_size == 0;
+        }
+
+        /**
+         * Returns the count of runs
+         * currently stored in files
+         */
+        size_type run_count() const noexcept {
+            return the_runs.size();
+        }
+
+        /**
+         * Returns the count of bytes
+         * written to the files so far
+         */
+        size_type bytes_written() const noexcept {
+            return the_bytes_written;
+        }
+
+        /**
+         * Returns the count of bytes
+         * read from the files so far
+         */
+        size_type bytes_read() const noexcept {
+            return the_bytes_read;
+        }
+
+        /**
+         * Returns the top element
+         */
+        const_reference top() const {
+            if (from_runs())
+                return the_runs[the_tree.winner()].head();
+
+            return the_inserted.top();
+        }
+
+        /**
+         * Adds element to the heap. May spill
+         * the in-memory part to a file
+         *
+         *   Time Complexity: O(log n) amortized, plus O(1 / B) I/O
+         * Memory Complexity: O(1) amortized
+         */
+        void push(const T & item) {
+            if (the_inserted.size() >= the_capacity) {
+                spill();
+            }
+
+            the_inserted.push(item);
+            the_size++;
+        }
+
+        /**
+         * Removes the top element
+         *
+         *   Time Complexity: O(log n) amortized, plus O(1 / B) I/O
+         * Memory Complexity: O(1)
+         */
+        void pop_top() {
+            if (from_runs()) {
+                advance(the_runs[the_tree.winner()]);
+                the_tree.replay();
+            } else {
+                the_inserted.pop_top();
+            }
+
+            the_size--;
+        }
+
+    private:
+        /**
+         * Sorted sequence stored in a file
+         * and read back one block at a time
+         */
+        struct run {
+            std::FILE * file = nullptr;
+            std::string path;
+            size_type level = 0;
+            size_type remaining = 0;
+            fast_vector<T> buffer;
+            size_type cursor = 0;
+
+            run() = default;
+
+            run(run && other) noexcept
+                : file(other.file), path(std::move(other.path)), level(other.level),
+                  remaining(other.remaining), buffer(std::move(other.buffer)), cursor(other.cursor) {
+                other.file = nullptr;
+            }
+
+            run & operator = (run && other) noexcept {
+                std::swap(file, other.file);
+                std::swap(path, other.path);
+                std::swap(level, other.level);
+                std::swap(remaining, other.remaining);
+                buffer.swap(other.buffer);
+                std::swap(cursor, other.cursor);
+                return *this;
+            }
+
+            ~run() {
+                if (file != nullptr) {
+                    std::fclose(file);
+
+                    if (!path.empty()) {
+                        std::remove(path.c_str());
+                    }
+                }
+            }
+
+            bool exhausted() const noexcept {
+                return cursor == buffer.size();
+            }
+
+            const T & head() const {
+                return buffer[cursor];
+            }
+        };
+
+        /**
+         * Asks the comparator which
+         * of the runs goes first
+         */
+        struct beats {
+            const std::vector<run> * runs;
+            const Compare * comparison;
+
+            bool operator () (size_t first, size_t second) const {
+                auto & a = (*runs)[first];
+                auto & b = (*runs)[second];
+
+                if (a.exhausted())
+                    return false;
+
+                if (b.exhausted())
+                    return true;
+
+                return (*comparison)(b.head(), a.head());
+            }
+        };
+
+        Compare the_comparison;
+        my::heap<T, Compare> the_inserted;
+        // moves the runs on growth, fast_vector would memcpy them
+        std::vector<run> the_runs;
+        loser_tree<beats> the_tree { 0, beats { &the_runs, &the_comparison } };
+        std::string the_directory;
+
+        size_type the_size = 0;
+        size_type the_block;
+        size_type the_capacity;
+        size_type the_max_runs;
+        size_type the_fan_in;
+
+        size_type the_bytes_written = 0;
+        size_type the_bytes_read = 0;
+
+        /**
+         * Returns true if the top comes
+         * from one of the runs
+         */
+        bool from_runs() const {
+            if (the_runs.empty() || the_runs[the_tree.winner()].exhausted())
+                return false;
+
+            if (the_inserted.empty())
+                return true;
+
+            return the_comparison(the_inserted.top(), the_runs[the_tree.winner()].head());
+        }
+
+        /**
+         * Opens a new file for a run
+         */
+        run create() {
+            run result;
+
+            if (the_directory.empty()) {
+                result.file = std::tmpfile();
+            } else {
+                result.file = create_temporary_file(the_directory, "external_heap_", result.path);
+            }
+
+            if (result.file == nullptr)
+                throw std::runtime_error("Could not create a run file");
+
+            return result;
+        }
+
+        /**
+         * Writes count elements to the run
+         */
+        void write(run & target, const T * items, size_type count) {
+            if (std::fwrite(items, sizeof(T), count, target.file) != count)
+                throw std::runtime_error("Could not write a run");
+
+            target.remaining += count;
+            the_bytes_written += count * sizeof(T);
+        }
+
+        /**
+         * Rewinds the written run and
+         * reads its first block
+         */
+        void finish(run & target) {
+            std::rewind(target.file);
+            target.buffer.reserve(the_block);
+            fill(target);
+        }
+
+        /**
+         * Reads the next block of the run
+         */
+        void fill(run & target) {
+            size_type count = target.remaining < the_block ? target.remaining : the_block;
+
+            target.buffer.resize(count);
+            target.cursor = 0;
+
+            if (count == 0)
+                return;
+
+            if (std::fread(target.buffer.data(), sizeof(T), count, target.file) != count)
+                throw std::runtime_error("Could not read a run");
+
+            target.remaining -= count;
+            the_bytes_read += count * sizeof(T);
+        }
+
+        /**
+         * Moves to the next element of the run
+         */
+        void advance(run & target) {
+            target.cursor++;
+
+            if (target.exhausted() && target.remaining != 0) {
+                fill(target);
+            }
+        }
+
+        /**
+         * Writes the in-memory heap out as a run
+         * of level 0 and merges every level that
+         * reached the_fan_in runs into the next one
+         */
+        void spill() {
+            std::vector<run> live;
+
+            for (auto & it : the_runs) {
+                if (!it.exhausted()) {
+                    live.push_back(std::move(it));
+                }
+            }
+
+            the_runs = std::move(live);
+
+            // too many levels for the memory budget
+            if (the_runs.size() + 1 > the_max_runs) {
+                size_type top = 0;
+
+                for (auto & it : the_runs) {
+                    top = it.level > top ? it.level : top;
+                }
+
+                merge([](const run &) { return true; }, top + 1);
+            }
+
+            run target = create();
+            fast_vector<T> block;
+            block.reserve(the_block);
+
+            while (!the_inserted.empty()) {
+                block.push_back(the_inserted.top());
+                the_inserted.pop_top();
+
+                if (block.size() == the_block) {
+                    write(target, block.data(), block.size());
+                    block.resize(0);
+                }
+            }
+
+            write(target, block.data(), block.size());
+            finish(target);
+
+            the_runs.push_back(std::move(target));
+
+            for (size_type level = 0; ; level++) {
+                size_type count = 0;
+
+                for (auto & it : the_runs) {
+                    count += it.level == level;
+                }
+
+                if (count < the_fan_in)
+                    break;
+
+                merge([level](const run & it) { return it.level == level; }, level + 1);
+            }
+
+            rebuild();
+        }
+
+        /**
+         * Merges the runs chosen by the
+         * predicate into one run of the level
+         */
+        template <typename Predicate>
+        void merge(Predicate chosen, size_type level) {
+            std::vector<run> sources;
+            std::vector<run> rest;
+
+            for (auto & it : the_runs) {
+                if (chosen(it)) {
+                    sources.push_back(std::move(it));
+                } else {
+                    rest.push_back(std::move(it));
+                }
+            }
+
+            the_runs = std::move(rest);
+
+            loser_tree<beats> tree(sources.size(), beats { &sources, &the_comparison });
+            tree.build();
+
+            run target = create();
+            fast_vector<T> block;
+            block.reserve(the_block);
+
+            while (!sources[tree.winner()].exhausted()) {
+                auto & source = sources[tree.winner()];
+                block.push_back(source.head());
+                advance(source);
+                tree.replay();
+
+                if (block.size() == the_block) {
+                    write(target, block.data(), block.size());
+                    block.resize(0);
+                }
+            }
+
+            write(target, block.data(), block.size());
+            finish(target);
+
+            target.level = level;
+            the_runs.push_back(std::move(target));
+        }
+
+        /**
+         * Replays all matches after
+         * the set of runs changed
+         */
+        void rebuild() {
+            the_tree = loser_tree<beats>(the_runs.size(), beats { &the_runs, &the_comparison });
+            the_tree.build();
+        }
+
+        /**
+         * Closes and removes all runs
+         */
+        void close_runs() {
+            the_runs.clear();
+        }
+    };
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+
+#include "external_heap.h"
+
+
+TEST(external_heap_tests, create_empty) {
+    my::external_heap<int> heap;
+    ASSERT_EQ(heap.size(), 0);
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(external_heap_tests, in_memory) {
+    auto numbers = std::initializer_list { 10, 14, 5, 3, 72, 156, -41, -6 };
+    my::external_heap<int> heap;
+
+    for (auto it = numbers.begin(); it != numbers.end(); it++) {
+        heap.push(*it);
+    }
+
+    ASSERT_EQ(heap.top(), 156);
+    ASSERT_EQ(heap.run_count(), 0);
+    ASSERT_EQ(heap.bytes_written(), 0);
+}
+
+
+template <typename Heap>
+void check_against_heap(Heap & heap) {
+    my::heap<long long, std::greater<long long>> reference;
+
+    for (int it = 0; it < 20000; it++) {
+        if (rand() % 3 == 0 && !reference.empty()) {
+            ASSERT_EQ(heap.top(), reference.top());
+            heap.pop_top();
+            reference.pop_top();
+        } else {
+            long long number = rand() % 100000;
+            heap.push(number);
+            reference.push(number);
+        }
+
+        ASSERT_EQ(heap.size(), reference.size());
+    }
+
+    while (!reference.empty()) {
+        ASSERT_EQ(heap.top(), reference.top());
+        heap.pop_top();
+        reference.pop_top();
+    }
+
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(external_heap_tests, spills_to_tmpfile) {
+    // 1000 elements in memory, blocks of 64 elements, up to 15 runs
+    my::external_heap<long long, std::greater<long long>> heap(16000, 512);
+    check_against_heap(heap);
+
+    ASSERT_GT(heap.bytes_written(), 0);
+    ASSERT_EQ(heap.bytes_read(), heap.bytes_written());
+}
+
+
+TEST(external_heap_tests, merges_by_levels) {
+    // 1000 elements in memory, up to 15 runs merged by 3
+    my::external_heap<long long, std::greater<long long>> heap(16000, 512);
+    const long long count = 512000;
+
+    for (long long it = 0; it < count; it++) {
+        heap.push((it * 7919) % count);
+    }
+
+    // 512 spills: every element is written once as
+    // a run and once per level, about 7 times, instead
+    // of once per merge of all runs, about 18 times
+    ASSERT_LE(heap.bytes_written(), 8 * count * sizeof(long long));
+    ASSERT_LE(heap.run_count(), 15);
+
+    for (long long it = 0; it < count; it++) {
+        ASSERT_EQ(heap.top(), it);
+        heap.pop_top();
+    }
+}
+
+
+TEST(external_heap_tests, spills_to_directory) {
+    my::external_heap<long long, std::greater<long long>> heap(16000, 512, ::testing::TempDir().c_str());
+    check_against_heap(heap);
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
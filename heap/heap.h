@@ -1,31 +1,74 @@
 #pragma once
 
+// for std::less
+#include <functional>
+// for std::min
+#include <algorithm>
+// for std::make_move_iterator, std::iterator_traits
+#include <iterator>
+// for std::is_base_of
+#include <type_traits>
+
 #include "../fast_vector/fast_vector.h"
+// for storing an empty comparator for free
+#include "../compressed_pair/compressed_pair.h"
 
 
 /**
  * Custom implementations
  */
 namespace my {
+    /**
+     * Comparator that returns true
+     * if first > second
+     */
     template <typename T>
-    using comparison = bool (T &, T &);
-
-    template <typename T>
-    bool greater(T & first, T & second) {
-        return first > second;
-    }
+    struct greater {
+        bool operator () (const T & first, const T & second) const {
+            return first > second;
+        }
+    };
 
+    /**
+     * Comparator that returns true
+     * if first < second
+     */
     template <typename T>
-    bool less(T & first, T & second) {
-        return first < second;
-    }
+    struct less {
+        bool operator () (const T & first, const T & second) const {
+            return first < second;
+        }
+    };
 
     /**
-     * Custom heap implementation
+     * Custom heap implementation.
+     * The element for which Compare returns
+     * false against any other is kept at the top,
+     * so the default std::less gives a max-heap.
+     *
+     * Every node has up to Arity children stored
+     * next to each other in a group starting at
+     * a multiple of Arity. With a cache-aligned
+     * allocator (see aligned_allocator.h) and
+     * Arity * sizeof(T) <= 64 every group fits
+     * into a single cache line.
+     *
+     * A larger Arity makes the tree shallower, so push
+     * does fewer moves, but every level of pop compares
+     * Arity children instead of 2. While the heap fits
+     * into cache 4 or 8 pays off for both (about 2x on
+     * pop at 10^4 ints); once it is out of cache every
+     * level costs a miss whatever the Arity and pop times
+     * are within noise of each other. Arity stays 2 by
+     * default, so heavy comparators and large T do not
+     * pay for the wider scan. See the disabled
+     * arity_benchmark in heap_tests.cpp
      */
     template <
         typename T,
-        typename Allocator = std::allocator<T>
+        typename Compare = std::less<T>,
+        typename Allocator = std::allocator<T>,
+        std::size_t Arity = 2
     >
     class heap {
     public:
@@ -43,6 +86,13 @@ namespace my {
          */
         using allocator_type = Allocator;
 
+        /**
+         * Allows to access comparator type.
+         * Despite value_compare is defined I prefer
+         * using Compare.
+         */
+        using value_compare = Compare;
+
         /**
          * Simplifies access to allocator traits
          */
@@ -79,95 +129,106 @@ namespace my {
             "Allocator::value_type must be same type as value_type"
         );
 
+        static_assert(
+            Arity >= 2 && (Arity & (Arity - 1)) == 0,
+            "Arity must be a power of 2"
+        );
+
+        /**
+         * Allows to access the count of children
+         * every node may have
+         */
+        static constexpr size_type arity = Arity;
+
         /**
          * Returns begin random_access_iterator
          */
         iterator begin() noexcept {
-            return the_storage.begin();
+            return storage().begin();
         }
 
         /**
          * Returns end random_access_iterator
          */
         iterator end() noexcept {
-            return the_storage.end();
+            return storage().end();
         }
 
         /**
          * Returns begin const random_access_iterator
          */
         const_iterator cbegin() const noexcept {
-            return the_storage.cbegin();
+            return storage().cbegin();
         }
 
         /**
          * Returns end const random_access_iterator
          */
         const_iterator cend() const noexcept {
-            return the_storage.cend();
+            return storage().cend();
         }
 
         /**
          * Returns begin reverse random_access_iterator
          */
         reverse_iterator rbegin() noexcept {
-            return the_storage.rbegin();
+            return storage().rbegin();
         }
 
         /**
          * Returns end reverse random_access_iterator
          */
         reverse_iterator rend() noexcept {
-            return the_storage.rend();
+            return storage().rend();
         }
 
         /**
          * Returns begin const reverse random_access_iterator
          */
         const_reverse_iterator crbegin() const noexcept {
-            return the_storage.crbegin();
+            return storage().crbegin();
         }
 
         /**
          * Returns end const reverse random_access_iterator
          */
         const_reverse_iterator crend() const noexcept {
-            return the_storage.crend();
+            return storage().crend();
         }
 
         /**
          * Returns the count of elements
          */
         size_type size() const noexcept {
-            return the_storage.size();
+            return storage().size();
         }
 
         /**
          * Returns the size of the inner storage
          */
         size_type capacity() const noexcept {
-            return the_storage.capacity();
+            return storage().capacity();
         }
 
         /**
          * Returns the maximum possible count of elements
          */
         size_type max_size() const noexcept {
-            return the_storage.max_size();
+            return storage().max_size();
         }
 
         /**
          * Returns an instance of allocator
          */
         Allocator get_allocator() const noexcept {
-            return the_storage.get_allocator();
+            return storage().get_allocator();
         }
 
         /**
          * Returns true if size is 0
          */
         bool empty() const noexcept {
-            return the_storage.empty();
+            return storage().empty();
         }
 
         /**
@@ -175,7 +236,7 @@ namespace my {
          * element at the given position
          */
         reference operator [] (size_type n) {
-            return the_storage[n];
+            return storage()[n];
         }
 
         /**
@@ -183,7 +244,7 @@ namespace my {
          * element at the given position
          */
         const_reference operator [] (size_type n) const {
-            return the_storage[n];
+            return storage()[n];
         }
 
         /**
@@ -192,7 +253,7 @@ namespace my {
          * Throws out_of_range on error
          */
         reference at(size_type n) {
-            return the_storage.at(n);
+            return storage().at(n);
         }
 
         /**
@@ -201,7 +262,7 @@ namespace my {
          * Throws out_of_range on error
          */
         const_reference at(size_type n) const {
-            return the_storage.at(n);
+            return storage().at(n);
         }
 
         /**
@@ -209,7 +270,7 @@ namespace my {
          * first element
          */
         reference front() {
-            return the_storage.front();
+            return storage().front();
         }
 
         /**
@@ -217,7 +278,7 @@ namespace my {
          * first element
          */
         const_reference front() const {
-            return the_storage.front();
+            return storage().front();
         }
 
         /**
@@ -225,7 +286,7 @@ namespace my {
          * last element
          */
         reference back() {
-            return the_storage.back();
+            return storage().back();
         }
 
         /**
@@ -233,7 +294,7 @@ namespace my {
          * last element
          */
         const_reference back() const {
-            return the_storage.back();
+            return storage().back();
         }
 
         /**
@@ -241,7 +302,7 @@ namespace my {
          * internal storage
          */
         pointer data() noexcept {
-            return the_storage.data();
+            return storage().data();
         }
 
         /**
@@ -249,16 +310,23 @@ namespace my {
          * internal storage
          */
         const_pointer data() const noexcept {
-            return the_storage.data();
+            return storage().data();
+        }
+
+        /**
+         * Returns a copy of the comparator
+         */
+        Compare value_comp() const {
+            return the_members.first();
         }
 
         /**
          * Constructs an empty heap
          */
         explicit heap(
-            comparison<T> comparison = less<T>,
+            const Compare & comparison = Compare(),
             const Allocator & allocator = Allocator()
-        ) : the_comparison(comparison), the_storage(0, allocator) {}
+        ) : the_members(comparison, fast_vector<T, Allocator>(allocator)) {}
 
         /**
          * Constructs a heap via copying
@@ -268,75 +336,300 @@ namespace my {
         heap(
             InputIterator first,
             InputIterator last,
-            comparison<T> comparison = less<T>,
+            const Compare & comparison = Compare(),
             const Allocator & allocator = Allocator()
-        ) : the_comparison(comparison), the_storage(first, last, allocator) {
+        ) : the_members(comparison, fast_vector<T, Allocator>(first, last, allocator)) {
             invalidate();
         }
 
+        /**
+         * Returns a const_reference to the
+         * top element
+         */
+        const_reference top() const {
+            return storage().front();
+        }
+
+        /**
+         * Adds element to the heap
+         */
+        void push(const T & item) {
+            emplace(item);
+        }
+
+        /**
+         * Adds element to the heap
+         */
+        void push(T && item) {
+            emplace(std::move(item));
+        }
+
+        /**
+         * Constructs the element directly in
+         * the inner storage and lifts it up
+         */
+        template <typename... K>
+        void emplace(K &&... arguments) {
+            storage().emplace_back(std::forward<K>(arguments)...);
+            lift(end() - 1);
+        }
+
+        /**
+         * Adds elements between first and last.
+         * Small batches are lifted one by one,
+         * large ones are appended and the whole
+         * heap is rebuilt. Single-pass input
+         * iterators can not be counted in advance,
+         * so their elements are pushed one by one
+         *
+         *   Time Complexity: O(min(k * log(n + k), n + k)), k = distance(first, last)
+         * Memory Complexity: O(1) amortized
+         */
+        template <typename InputIterator>
+        void push_range(InputIterator first, InputIterator last) {
+            using category = typename std::iterator_traits<InputIterator>::iterator_category;
+
+            if constexpr (!std::is_base_of<std::forward_iterator_tag, category>::value) {
+                for (; first != last; ++first) {
+                    emplace(*first);
+                }
+
+                return;
+            }
+
+            size_type old_size = size();
+            size_type count = std::distance(first, last);
+
+            storage().reserve(old_size + count);
+
+            while (first != last) {
+                storage().emplace_back(*first);
+                first++;
+            }
+
+            if (count * depth(size()) > size()) {
+                invalidate();
+            } else {
+                for (size_type it = old_size; it < size(); it++) {
+                    lift(begin() + it);
+                }
+            }
+        }
+
+        /**
+         * Moves all elements of other into itself.
+         * The larger of the two storages is kept
+         * and the other one is released
+         *
+         *   Time Complexity: O(min(k * log(n + k), n + k)), k = the smaller size
+         * Memory Complexity: O(1) amortized
+         */
+        void merge(heap && other) {
+            if (other.capacity() > capacity()) {
+                storage().swap(other.storage());
+            }
+
+            push_range(
+                std::make_move_iterator(other.begin()),
+                std::make_move_iterator(other.end())
+            );
+
+            other.storage().clear();
+        }
+
         /**
          * Removes the top element
          */
         void pop_top() {
-            the_storage.erase(the_storage.begin());
-            invalidate();
+            if (size() > 1) {
+                front() = std::move(back());
+                storage().pop_back();
+                drown(begin());
+            } else {
+                storage().pop_back();
+            }
         }
 
     private:
-        comparison<T> * the_comparison;
-        fast_vector<T, Allocator> the_storage;
+        /**
+         * The comparator goes first so that
+         * a stateless one takes no space
+         */
+        compressed_pair<Compare, fast_vector<T, Allocator>> the_members;
+
+        /**
+         * Returns the inner storage
+         */
+        fast_vector<T, Allocator> & storage() noexcept {
+            return the_members.second();
+        }
+
+        /**
+         * Returns the inner storage
+         */
+        const fast_vector<T, Allocator> & storage() const noexcept {
+            return the_members.second();
+        }
+
+        /**
+         * Returns true if first must
+         * be placed below second
+         */
+        bool compare(const T & first, const T & second) const {
+            return the_members.first()(first, second);
+        }
+
+        /**
+         * Returns the index of the first child
+         * of the node at the given index.
+         * The root only owns Arity - 1 children
+         * (1 .. Arity - 1) so that the children of
+         * every node form an Arity-aligned group
+         */
+        static size_type first_child(size_type index) noexcept {
+            return index == 0 ? 1 : index * Arity;
+        }
+
+        /**
+         * Returns the index of the parent
+         * of the node at the given non-zero index
+         */
+        static size_type parent(size_type index) noexcept {
+            return index / Arity;
+        }
+
+        /**
+         * Returns the index of the child that
+         * must go above all its siblings in [first, last).
+         * Small trivially copyable keys are kept in
+         * a register during the scan and full groups
+         * are scanned with a fixed trip count and no
+         * branches, so the compiler is free to unroll
+         * it into conditional moves or vector code
+         */
+        size_type best_child(size_type first, size_type last) const {
+            const T * items = data();
+            size_type best = first;
+
+            if constexpr (std::is_trivially_copyable<T>::value && sizeof(T) <= 2 * sizeof(void *)) {
+                T best_value = items[first];
+
+                if (last - first == Arity) {
+                    for (size_type it = first + 1; it < first + Arity; it++) {
+                        bool better = compare(best_value, items[it]);
+                        best       = better ? it        : best;
+                        best_value = better ? items[it] : best_value;
+                    }
+                } else {
+                    for (size_type it = first + 1; it < last; it++) {
+                        bool better = compare(best_value, items[it]);
+                        best       = better ? it        : best;
+                        best_value = better ? items[it] : best_value;
+                    }
+                }
+            } else {
+                for (size_type it = first + 1; it < last; it++) {
+                    if (compare(items[best], items[it])) {
+                        best = it;
+                    }
+                }
+            }
+
+            return best;
+        }
 
         /**
          * Drows the given element down
          * to it's proper place.
-         * Linear time complexity
+         *
+         *   Time Complexity: O(Arity * log_Arity(n))
+         * Memory Complexity: O(1)
          */
         void drown(pointer it) {
-            auto index = it - begin();
+            size_type count = size();
+            size_type index = it - begin();
+            pointer items = data();
 
-            auto RIGHT = it + index + 1;
-            auto LEFT  = it + index;
+            T value = std::move(items[index]);
 
-            bool has_right = RIGHT < end();
-            bool has_left  = LEFT  < end();
+            while (true) {
+                size_type first = first_child(index);
 
-            bool must_swap_right = false;
-            bool must_swap_left  = false;
+                if (first >= count)
+                    break;
 
-            if (has_right) {
-                must_swap_right = the_comparison(*it, *RIGHT);
-            }
+                size_type last = std::min((index + 1) * Arity, count);
+                size_type best = best_child(first, last);
 
-            if (has_left) {
-                must_swap_left = the_comparison(*it, *LEFT);
+                if (!compare(value, items[best]))
+                    break;
+
+                items[index] = std::move(items[best]);
+                index = best;
             }
 
-            if (must_swap_right && must_swap_left) {
-                auto target = RIGHT;
+            items[index] = std::move(value);
+        }
 
-                if (the_comparison(*RIGHT, *LEFT)) {
-                    target = LEFT;
-                }
+        /**
+         * Lifts the given element up
+         * to it's proper place.
+         *
+         *   Time Complexity: O(log_Arity(n))
+         * Memory Complexity: O(1)
+         */
+        void lift(pointer it) {
+            size_type index = it - begin();
+            pointer items = data();
+
+            T value = std::move(items[index]);
+
+            while (index != 0) {
+                size_type above = parent(index);
+
+                if (!compare(items[above], value))
+                    break;
 
-                std::swap(*it, *target);
-                drown(target);
-            } else if (must_swap_right) {
-                std::swap(*it, *RIGHT);
-                drown(RIGHT);
-            } else if (must_swap_left) {
-                std::swap(*it, *LEFT);
-                drown(LEFT);
+                items[index] = std::move(items[above]);
+                index = above;
             }
+
+            items[index] = std::move(value);
         }
 
         /**
          * Ensures that all elements
-         * are at the proper places
+         * are at the proper places.
+         * Drowns every inner node starting from
+         * the last one (Floyd's heap construction)
+         *
+         *   Time Complexity: O(n)
+         * Memory Complexity: O(1)
          */
         void invalidate() {
-            for (auto it = rbegin(); it != rend(); it--) {
-                drown(it);
+            size_type count = size();
+
+            if (count < 2)
+                return;
+
+            for (size_type it = parent(count - 1) + 1; it > 0; it--) {
+                drown(begin() + it - 1);
             }
         }
+
+        /**
+         * Returns the count of levels of
+         * a heap with the given count of elements
+         */
+        static size_type depth(size_type count) noexcept {
+            size_type levels = 0;
+
+            while (count > 0) {
+                count /= Arity;
+                levels++;
+            }
+
+            return levels;
+        }
     };
 }
\ No newline at end of file
@@ -2,9 +2,14 @@
 
 #include <iostream>
 #include <initializer_list>
+#include <random>
+#include <chrono>
+#include <sstream>
+#include <iterator>
 
 
 #include "heap.h"
+#include "../aligned_allocator/aligned_allocator.h"
 
 
 TEST(heap_tests, create_empty) {
@@ -33,7 +38,7 @@ void print_heap(my::heap<T> heap) {
 
 TEST(heap_tests, create_from_iterable_by_min) {
     auto numbers = std::initializer_list { 10, 14, 5, 3, 72, 156, -41, -6 };
-    my::heap<int> heap(numbers.begin(), numbers.end(), my::less);
+    my::heap<int, my::less<int>> heap(numbers.begin(), numbers.end());
 
     ASSERT_EQ(heap.size(), numbers.size());
 
@@ -53,7 +58,7 @@ TEST(heap_tests, create_from_iterable_by_min) {
 
 TEST(heap_tests, create_from_iterable_by_max) {
     auto numbers = std::initializer_list { 10, 14, 5, 3, 72, 156, -41, -6 };
-    my::heap<int> heap(numbers.begin(), numbers.end(), my::greater);
+    my::heap<int, my::greater<int>> heap(numbers.begin(), numbers.end());
 
     ASSERT_EQ(heap.size(), numbers.size());
 
@@ -71,6 +76,212 @@ TEST(heap_tests, create_from_iterable_by_max) {
 }
 
 
+TEST(heap_tests, create_with_lambda) {
+    auto numbers = std::initializer_list { 10, 14, 5, 3, 72, 156, -41, -6 };
+    auto by_distance = [](int first, int second) {
+        return std::abs(first - 50) > std::abs(second - 50);
+    };
+    my::heap<int, decltype(by_distance)> heap(numbers.begin(), numbers.end(), by_distance);
+
+    ASSERT_EQ(heap.size(), numbers.size());
+    ASSERT_EQ(heap.front(), 72);
+}
+
+
+TEST(heap_tests, create_with_function_pointer) {
+    auto numbers = std::initializer_list { 10, 14, 5, 3, 72, 156, -41, -6 };
+    using comparison = bool (*) (const int &, const int &);
+    comparison by_max = [](const int & first, const int & second) {
+        return first < second;
+    };
+    my::heap<int, comparison> heap(numbers.begin(), numbers.end(), by_max);
+
+    ASSERT_EQ(heap.size(), numbers.size());
+    ASSERT_EQ(heap.front(), 156);
+}
+
+
+TEST(heap_tests, stateless_comparator_is_free) {
+    ASSERT_EQ(sizeof(my::heap<int>), sizeof(my::fast_vector<int>));
+    ASSERT_EQ(sizeof(my::heap<int, my::greater<int>>), sizeof(my::fast_vector<int>));
+}
+
+
+template <typename Heap>
+void assert_heap_property(Heap & heap) {
+    auto compare = heap.value_comp();
+
+    for (size_t it = 1; it < heap.size(); it++) {
+        ASSERT_FALSE(compare(heap[it / Heap::arity], heap[it]));
+    }
+}
+
+
+template <typename Heap>
+void assert_pops_sorted(Heap & heap) {
+    auto compare = heap.value_comp();
+
+    while (heap.size() > 1) {
+        auto top = heap.top();
+        heap.pop_top();
+        ASSERT_FALSE(compare(top, heap.top()));
+    }
+
+    heap.pop_top();
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(heap_tests, push_and_pop) {
+    my::heap<int> heap;
+
+    for (int it = 0; it < 1000; it++) {
+        heap.push(rand() % 100);
+        assert_heap_property(heap);
+    }
+
+    ASSERT_EQ(heap.size(), 1000);
+    assert_pops_sorted(heap);
+}
+
+
+TEST(heap_tests, d_ary) {
+    my::fast_vector<int> numbers;
+
+    for (int it = 0; it < 1000; it++) {
+        numbers.push_back(rand() % 100);
+    }
+
+    my::heap<int, std::less<int>, std::allocator<int>, 4> quaternary(numbers.begin(), numbers.end());
+    assert_heap_property(quaternary);
+    assert_pops_sorted(quaternary);
+
+    my::heap<int, std::greater<int>, my::aligned_allocator<int>, 8> octonary;
+
+    for (auto it = numbers.begin(); it != numbers.end(); it++) {
+        octonary.push(*it);
+    }
+
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(octonary.data()) % 64, 0);
+    assert_heap_property(octonary);
+    assert_pops_sorted(octonary);
+}
+
+
+/**
+ * Prints nanoseconds per push and per pop of
+ * random keys for the given arity. Run with
+ * --gtest_also_run_disabled_tests
+ */
+template <size_t Arity>
+void benchmark_arity(size_t size) {
+    my::heap<uint32_t, std::less<uint32_t>, my::aligned_allocator<uint32_t>, Arity> heap;
+    std::mt19937 generator(42);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t it = 0; it < size; it++) {
+        heap.push(generator());
+    }
+
+    auto middle = std::chrono::steady_clock::now();
+    uint32_t sink = 0;
+
+    for (size_t it = 0; it < size; it++) {
+        sink ^= heap.top();
+        heap.pop_top();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    using nanoseconds = std::chrono::duration<double, std::nano>;
+
+    std::cout << "d" << Arity << " n = " << size
+        << " push " << nanoseconds(middle - start).count() / size
+        << " pop " << nanoseconds(end - middle).count() / size
+        << " ns (" << sink << ")" << std::endl;
+}
+
+
+TEST(heap_tests, DISABLED_arity_benchmark) {
+    for (size_t size : { 10000, 1000000, 10000000 }) {
+        benchmark_arity<2>(size);
+        benchmark_arity<4>(size);
+        benchmark_arity<8>(size);
+    }
+}
+
+
+TEST(heap_tests, heapify_large) {
+    my::fast_vector<int> numbers;
+
+    for (int it = 0; it < 100000; it++) {
+        numbers.push_back(rand());
+    }
+
+    my::heap<int> heap(numbers.begin(), numbers.end());
+    assert_heap_property(heap);
+    ASSERT_EQ(heap.top(), *std::max_element(numbers.begin(), numbers.end()));
+}
+
+
+TEST(heap_tests, push_range) {
+    my::heap<int, std::greater<int>> heap;
+    my::fast_vector<int> small = { 5, 3, 8 };
+    my::fast_vector<int> large;
+
+    for (int it = 0; it < 1000; it++) {
+        large.push_back(rand() % 1000);
+    }
+
+    heap.push_range(large.begin(), large.end());
+    assert_heap_property(heap);
+
+    heap.push_range(small.begin(), small.end());
+    assert_heap_property(heap);
+
+    ASSERT_EQ(heap.size(), 1003);
+    assert_pops_sorted(heap);
+}
+
+
+TEST(heap_tests, push_range_single_pass) {
+    my::heap<int, std::greater<int>> heap;
+    std::istringstream input("7 1 9 4 4 2");
+
+    heap.push_range(std::istream_iterator<int>(input), std::istream_iterator<int>());
+
+    ASSERT_EQ(heap.size(), 6);
+    ASSERT_EQ(heap.top(), 1);
+    assert_pops_sorted(heap);
+}
+
+
+TEST(heap_tests, merge) {
+    my::heap<int> first;
+    my::heap<int> second;
+
+    for (int it = 0; it < 100; it++) {
+        first.push(rand() % 1000);
+    }
+
+    for (int it = 0; it < 1000; it++) {
+        second.push(rand() % 1000);
+    }
+
+    auto largest = std::max(first.top(), second.top());
+    auto storage = second.data();
+
+    first.merge(std::move(second));
+
+    ASSERT_EQ(first.size(), 1100);
+    ASSERT_EQ(first.data(), storage);
+    ASSERT_EQ(first.top(), largest);
+    ASSERT_TRUE(second.empty());
+    assert_heap_property(first);
+    assert_pops_sorted(first);
+}
+
+
 int main(int argc, char * argv[]) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,414 @@
+#pragma once
+
+// for std::less
+#include <functional>
+// for std::numeric_limits
+#include <limits>
+// for std::vector
+#include <vector>
+// for std::optional
+#include <optional>
+// for std::out_of_range, std::invalid_argument
+#include <stdexcept>
+
+#include "../fast_vector/fast_vector.h"
+// for storing an empty comparator for free
+#include "../compressed_pair/compressed_pair.h"
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Heap of keys ordered by their priorities
+     * that hands out a stable handle for every
+     * pushed key. The handle allows to change
+     * the priority of the key or remove it
+     * without searching for it.
+     *
+     * Ordering follows my::heap: the priority for
+     * which Compare returns false against any other
+     * is kept at the top, so the default std::less
+     * gives a max-heap and std::greater gives
+     * a min-heap suitable for shortest paths.
+     *
+     * A handle stays valid until its key is popped
+     * or erased, after that it may be reused.
+     * Changing or erasing a key behind a handle
+     * that is not in the heap throws std::out_of_range
+     */
+    template <
+        typename Key,
+        typename Priority,
+        typename Compare = std::less<Priority>
+    >
+    class indexed_heap {
+    public:
+        /**
+         * Allows to access template types.
+         * Despite these definitions exist I prefer
+         * using Key, Priority and Compare.
+         */
+        using      key_type = Key;
+        using priority_type = Priority;
+        using value_compare = Compare;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using size_type = size_t;
+
+        /**
+         * Identifies a pushed key
+         */
+        using handle = size_type;
+
+        /**
+         * Position of a handle that is
+         * not in the heap
+         */
+        static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+        /**
+         * Constructs an empty heap
+         */
+        explicit indexed_heap(
+            const Compare & comparison = Compare()
+        ) : the_members(comparison) {}
+
+        /**
+         * Returns the count of keys
+         */
+        size_type size() const noexcept {
+            return nodes().size();
+        }
+
+        /**
+         * Returns true if size is 0
+         */
+        bool empty() const noexcept {
+            return nodes().empty();
+        }
+
+        /**
+         * Returns a copy of the comparator
+         */
+        Compare value_comp() const {
+            return the_members.first();
+        }
+
+        /**
+         * Returns true if the key behind
+         * the handle is still in the heap
+         */
+        bool contains(handle it) const noexcept {
+            return it < the_positions.size() && the_positions[it] != npos;
+        }
+
+        /**
+         * Returns the key behind the handle.
+         * The handle must be in the heap
+         */
+        const Key & key(handle it) const {
+            return *the_keys[it];
+        }
+
+        /**
+         * Returns the current priority of the key
+         * behind the handle. The handle must be
+         * in the heap
+         */
+        const Priority & priority(handle it) const {
+            return nodes()[the_positions[it]].priority;
+        }
+
+        /**
+         * Returns the top key.
+         * The heap must not be empty
+         */
+        const Key & top() const {
+            return *the_keys[nodes().front().key];
+        }
+
+        /**
+         * Returns the priority of the top key.
+         * The heap must not be empty
+         */
+        const Priority & top_priority() const {
+            return nodes().front().priority;
+        }
+
+        /**
+         * Returns the handle of the top key.
+         * The heap must not be empty
+         */
+        handle top_handle() const {
+            return nodes().front().key;
+        }
+
+        /**
+         * Adds the key with the given priority
+         * and returns its handle.
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1) amortized
+         */
+        handle push(const Key & key, const Priority & priority) {
+            handle it = acquire(key);
+
+            nodes().push_back(node { priority, it });
+            the_positions[it] = size() - 1;
+            lift(size() - 1);
+
+            return it;
+        }
+
+        /**
+         * Removes the top key.
+         * The heap must not be empty
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1)
+         */
+        void pop_top() {
+            erase(top_handle());
+        }
+
+        /**
+         * Removes the key behind the handle
+         * and destroys it
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1)
+         */
+        void erase(handle it) {
+            check(it);
+
+            size_type index = the_positions[it];
+            size_type last = size() - 1;
+
+            the_free.push_back(it);
+            the_positions[it] = npos;
+            the_keys[it].reset();
+
+            if (index != last) {
+                place(index, nodes()[last]);
+                nodes().pop_back();
+                restore(index);
+            } else {
+                nodes().pop_back();
+            }
+        }
+
+        /**
+         * Makes the priority of the key smaller
+         * as told by operator <. Note that with the
+         * default std::less this moves the key away
+         * from the top. Throws std::invalid_argument
+         * if the new priority is greater
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1)
+         */
+        void decrease_key(handle it, const Priority & priority) {
+            check(it);
+
+            if (this->priority(it) < priority)
+                throw std::invalid_argument("New priority is greater than the current one");
+
+            update(it, priority);
+        }
+
+        /**
+         * Makes the priority of the key greater
+         * as told by operator <. Note that with the
+         * default std::less this moves the key towards
+         * the top. Throws std::invalid_argument
+         * if the new priority is smaller
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1)
+         */
+        void increase_key(handle it, const Priority & priority) {
+            check(it);
+
+            if (priority < this->priority(it))
+                throw std::invalid_argument("New priority is smaller than the current one");
+
+            update(it, priority);
+        }
+
+        /**
+         * Sets the priority of the key to any value
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1)
+         */
+        void update(handle it, const Priority & priority) {
+            check(it);
+
+            size_type index = the_positions[it];
+            nodes()[index].priority = priority;
+            restore(index);
+        }
+
+    private:
+        /**
+         * Heap element. Priorities are kept
+         * next to the handles so that sifting
+         * never has to look into the_keys
+         */
+        struct node {
+            Priority priority;
+            handle key;
+        };
+
+        /**
+         * The comparator goes first so that
+         * a stateless one takes no space
+         */
+        compressed_pair<Compare, fast_vector<node>> the_members;
+
+        /**
+         * Keys indexed by handles. Empty for
+         * free handles, so popped keys do not
+         * live until their handle is reused.
+         * std::vector moves keys on growth
+         * instead of copying their bytes
+         */
+        std::vector<std::optional<Key>> the_keys;
+
+        /**
+         * Positions in nodes() indexed by handles.
+         * Updated on every move of a node
+         */
+        fast_vector<size_type> the_positions;
+
+        /**
+         * Handles that may be reused
+         */
+        fast_vector<handle> the_free;
+
+        /**
+         * Returns the heap array
+         */
+        fast_vector<node> & nodes() noexcept {
+            return the_members.second();
+        }
+
+        /**
+         * Returns the heap array
+         */
+        const fast_vector<node> & nodes() const noexcept {
+            return the_members.second();
+        }
+
+        /**
+         * Returns true if first must
+         * be placed below second
+         */
+        bool compare(const Priority & first, const Priority & second) const {
+            return the_members.first()(first, second);
+        }
+
+        /**
+         * Throws if the handle is not in the heap
+         */
+        void check(handle it) const {
+            if (!contains(it))
+                throw std::out_of_range("Handle is not in the heap");
+        }
+
+        /**
+         * Stores the key under a free handle
+         */
+        handle acquire(const Key & key) {
+            if (the_free.empty()) {
+                the_keys.emplace_back(key);
+                the_positions.push_back(npos);
+                return the_keys.size() - 1;
+            }
+
+            handle it = the_free.back();
+            the_free.pop_back();
+            the_keys[it] = key;
+
+            return it;
+        }
+
+        /**
+         * Puts the node at the index and
+         * remembers its new position
+         */
+        void place(size_type index, const node & item) {
+            nodes()[index] = item;
+            the_positions[item.key] = index;
+        }
+
+        /**
+         * Moves the node at the index either up
+         * or down depending on its priority
+         */
+        void restore(size_type index) {
+            if (index != 0 && compare(nodes()[index / 2].priority, nodes()[index].priority)) {
+                lift(index);
+            } else {
+                drown(index);
+            }
+        }
+
+        /**
+         * Lifts the node at the index up
+         * to it's proper place. Uses the layout
+         * of my::heap: the root owns the child 1,
+         * every other node i owns 2i and 2i + 1
+         */
+        void lift(size_type index) {
+            node item = nodes()[index];
+
+            while (index != 0) {
+                size_type parent = index / 2;
+
+                if (!compare(nodes()[parent].priority, item.priority))
+                    break;
+
+                place(index, nodes()[parent]);
+                index = parent;
+            }
+
+            place(index, item);
+        }
+
+        /**
+         * Drows the node at the index down
+         * to it's proper place
+         */
+        void drown(size_type index) {
+            size_type count = size();
+            node item = nodes()[index];
+
+            while (true) {
+                size_type first = index == 0 ? 1 : index * 2;
+
+                if (first >= count)
+                    break;
+
+                size_type best = first;
+                size_type last = index * 2 + 1;
+
+                if (last > first && last < count && compare(nodes()[first].priority, nodes()[last].priority)) {
+                    best = last;
+                }
+
+                if (!compare(item.priority, nodes()[best].priority))
+                    break;
+
+                place(index, nodes()[best]);
+                index = best;
+            }
+
+            place(index, item);
+        }
+    };
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <memory>
+
+
+#include "indexed_heap.h"
+
+
+template <typename Heap>
+void assert_heap_property(const Heap & heap, const my::fast_vector<size_t> & handles) {
+    auto compare = heap.value_comp();
+
+    for (auto it = handles.cbegin(); it != handles.cend(); it++) {
+        if (heap.contains(*it)) {
+            ASSERT_FALSE(compare(heap.top_priority(), heap.priority(*it)));
+        }
+    }
+}
+
+
+TEST(indexed_heap_tests, create_empty) {
+    my::indexed_heap<char, int> heap;
+    ASSERT_EQ(heap.size(), 0);
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(indexed_heap_tests, push_and_pop) {
+    my::indexed_heap<char, int, std::greater<int>> heap;
+
+    heap.push('c', 30);
+    heap.push('a', 10);
+    heap.push('d', 40);
+    heap.push('b', 20);
+
+    ASSERT_EQ(heap.size(), 4);
+
+    for (auto name : { 'a', 'b', 'c', 'd' }) {
+        ASSERT_EQ(heap.top(), name);
+        heap.pop_top();
+    }
+
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(indexed_heap_tests, decrease_and_increase_key) {
+    my::indexed_heap<char, int, std::greater<int>> heap;
+
+    auto a = heap.push('a', 10);
+    auto b = heap.push('b', 20);
+    auto c = heap.push('c', 30);
+
+    heap.decrease_key(c, 5);
+    ASSERT_EQ(heap.top(), 'c');
+    ASSERT_EQ(heap.priority(c), 5);
+
+    heap.increase_key(c, 50);
+    ASSERT_EQ(heap.top(), 'a');
+
+    heap.increase_key(a, 25);
+    ASSERT_EQ(heap.top_handle(), b);
+
+    // moves in the wrong direction are rejected
+    ASSERT_THROW(heap.decrease_key(b, 21), std::invalid_argument);
+    ASSERT_THROW(heap.increase_key(b, 19), std::invalid_argument);
+    ASSERT_EQ(heap.priority(b), 20);
+}
+
+
+TEST(indexed_heap_tests, erase) {
+    my::indexed_heap<int, int> heap;
+
+    auto a = heap.push(1, 10);
+    auto b = heap.push(2, 20);
+    auto c = heap.push(3, 30);
+
+    heap.erase(b);
+    ASSERT_FALSE(heap.contains(b));
+    ASSERT_TRUE(heap.contains(a));
+    ASSERT_EQ(heap.size(), 2);
+
+    heap.erase(c);
+    ASSERT_EQ(heap.top(), 1);
+
+    // handles are reused
+    ASSERT_EQ(heap.push(4, 40), c);
+    ASSERT_EQ(heap.top(), 4);
+
+    // stale handles are rejected
+    ASSERT_THROW(heap.erase(b), std::out_of_range);
+    ASSERT_THROW(heap.update(b, 5), std::out_of_range);
+    ASSERT_THROW(heap.update(100, 5), std::out_of_range);
+    ASSERT_EQ(heap.size(), 2);
+}
+
+
+TEST(indexed_heap_tests, release_keys) {
+    my::indexed_heap<std::shared_ptr<int>, int> heap;
+    auto key = std::make_shared<int>(1);
+
+    heap.push(key, 10);
+    heap.push(std::make_shared<int>(2), 20);
+    ASSERT_EQ(key.use_count(), 2);
+
+    // popped keys are destroyed before
+    // their handles are reused
+    heap.pop_top();
+    heap.pop_top();
+    ASSERT_EQ(key.use_count(), 1);
+}
+
+
+TEST(indexed_heap_tests, random_operations) {
+    my::indexed_heap<int, int, std::greater<int>> heap;
+    my::fast_vector<size_t> handles;
+
+    for (int it = 0; it < 2000; it++) {
+        auto action = rand() % 4;
+
+        if (action == 0 && !heap.empty()) {
+            heap.pop_top();
+        } else if (action == 1 && !handles.empty()) {
+            auto handle = handles[rand() % handles.size()];
+
+            if (heap.contains(handle)) {
+                heap.update(handle, rand() % 1000);
+            }
+        } else if (action == 2 && !handles.empty()) {
+            auto handle = handles[rand() % handles.size()];
+
+            if (heap.contains(handle)) {
+                heap.erase(handle);
+            }
+        } else {
+            handles.push_back(heap.push(it, rand() % 1000));
+        }
+
+        assert_heap_property(heap, handles);
+    }
+
+    int previous = -1;
+
+    while (!heap.empty()) {
+        ASSERT_LE(previous, heap.top_priority());
+        previous = heap.top_priority();
+        heap.pop_top();
+    }
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
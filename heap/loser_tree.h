@@ -0,0 +1,134 @@
+#pragma once
+
+// for std::swap
+#include <utility>
+
+#include "../fast_vector/fast_vector.h"
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Tournament tree that remembers the loser of
+     * every match. Selects the best of k players
+     * and, once the winner's key changes, finds the
+     * new winner with log_2(k) matches along a single
+     * path instead of comparing siblings on the way.
+     *
+     * Players are indices 0 .. k - 1. Beats is called
+     * as beats(i, j) and must return true if player i
+     * must come before player j. Players that ran out
+     * of keys must lose to every other player
+     */
+    template <typename Beats>
+    class loser_tree {
+    public:
+        /**
+         * Generalizes memory menagement types
+         */
+        using size_type = size_t;
+
+        /**
+         * Constructs a tree for the given count
+         * of players. Call build() before use
+         */
+        explicit loser_tree(
+            size_type count,
+            const Beats & beats = Beats()
+        ) : the_beats(beats), the_count(count), the_losers(count, 0) {}
+
+        /**
+         * Returns the count of players
+         */
+        size_type size() const noexcept {
+            return the_count;
+        }
+
+        /**
+         * Returns the current winner
+         */
+        size_type winner() const noexcept {
+            return the_winner;
+        }
+
+        /**
+         * Returns the player that would win if the
+         * current winner left: the best of the players
+         * that lost to it. Returns the winner if there
+         * is no other player
+         *
+         *   Time Complexity: O(log_2(k))
+         * Memory Complexity: O(1)
+         */
+        size_type runner_up() const {
+            size_type result = the_winner;
+
+            for (size_type node = (the_count + the_winner) / 2; node > 0; node /= 2) {
+                size_type loser = the_losers[node];
+
+                if (result == the_winner || the_beats(loser, result)) {
+                    result = loser;
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * Plays all matches from scratch
+         *
+         *   Time Complexity: O(k)
+         * Memory Complexity: O(k)
+         */
+        void build() {
+            the_winner = 0;
+
+            if (the_count <= 1)
+                return;
+
+            // winners of the inner nodes, leaves are k .. 2k - 1
+            fast_vector<size_type> winners(the_count, 0);
+
+            for (size_type node = the_count - 1; node > 0; node--) {
+                size_type left  = 2 * node     < the_count ? winners[2 * node]     : 2 * node     - the_count;
+                size_type right = 2 * node + 1 < the_count ? winners[2 * node + 1] : 2 * node + 1 - the_count;
+
+                if (the_beats(right, left)) {
+                    std::swap(left, right);
+                }
+
+                winners[node] = left;
+                the_losers[node] = right;
+            }
+
+            the_winner = winners[1];
+        }
+
+        /**
+         * Finds the new winner after
+         * the key of the old one changed
+         *
+         *   Time Complexity: O(log_2(k))
+         * Memory Complexity: O(1)
+         */
+        void replay() {
+            size_type current = the_winner;
+
+            for (size_type node = (the_count + current) / 2; node > 0; node /= 2) {
+                if (the_beats(the_losers[node], current)) {
+                    std::swap(the_losers[node], current);
+                }
+            }
+
+            the_winner = current;
+        }
+
+    private:
+        Beats the_beats;
+        size_type the_count;
+        size_type the_winner = 0;
+        fast_vector<size_type> the_losers;
+    };
+}
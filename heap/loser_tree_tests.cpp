@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+
+#include "loser_tree.h"
+
+
+TEST(loser_tree_tests, merges_sequences) {
+    for (size_t count = 1; count < 12; count++) {
+        my::fast_vector<my::fast_vector<int>> sequences;
+        my::fast_vector<size_t> cursors(count, 0);
+        size_t total = 0;
+
+        for (size_t it = 0; it < count; it++) {
+            sequences.emplace_back();
+
+            int value = 0;
+            int length = rand() % 20;
+
+            for (int that = 0; that < length; that++) {
+                value += rand() % 5;
+                sequences[it].push_back(value);
+            }
+
+            total += sequences[it].size();
+        }
+
+        auto beats = [&](size_t first, size_t second) {
+            if (cursors[first] == sequences[first].size())
+                return false;
+
+            if (cursors[second] == sequences[second].size())
+                return true;
+
+            return sequences[first][cursors[first]] < sequences[second][cursors[second]];
+        };
+
+        my::loser_tree<decltype(beats)> tree(count, beats);
+        tree.build();
+
+        int previous = -1;
+
+        for (size_t it = 0; it < total; it++) {
+            auto winner = tree.winner();
+            ASSERT_LT(cursors[winner], sequences[winner].size());
+            ASSERT_LE(previous, sequences[winner][cursors[winner]]);
+
+            // nobody but the winner beats the runner-up
+            auto runner_up = tree.runner_up();
+            ASSERT_TRUE(count == 1 || runner_up != winner);
+
+            for (size_t that = 0; that < count; that++) {
+                if (that != winner) {
+                    ASSERT_FALSE(beats(that, runner_up));
+                }
+            }
+
+            previous = sequences[winner][cursors[winner]];
+            cursors[winner]++;
+            tree.replay();
+        }
+
+        auto winner = tree.winner();
+        ASSERT_EQ(cursors[winner], sequences[winner].size());
+    }
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
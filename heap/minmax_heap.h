@@ -0,0 +1,299 @@
+#pragma once
+
+// for std::less
+#include <functional>
+// for std::swap
+#include <utility>
+
+#include "../fast_vector/fast_vector.h"
+// for storing an empty comparator for free
+#include "../compressed_pair/compressed_pair.h"
+// for bit_width
+#include "../auxiliary/algorithm.h"
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Double-ended priority queue (min-max heap).
+     * Nodes on even levels are not greater than
+     * any of their descendants, nodes on odd levels
+     * are not less than them. Thus the minimum is
+     * the root and the maximum is one of its children.
+     * Compare defines what "less" means.
+     * Uses the plain layout: node i owns 2i + 1 and 2i + 2
+     */
+    template <
+        typename T,
+        typename Compare = std::less<T>,
+        typename Allocator = std::allocator<T>
+    >
+    class minmax_heap {
+    public:
+        /**
+         * Allows to access template type T.
+         * Despite value_type is defined I prefer
+         * using T.
+         */
+        using value_type = T;
+
+        /**
+         * Allows to access allocator type.
+         * Despite allocator_type is defined I prefer
+         * using Allocator.
+         */
+        using allocator_type = Allocator;
+
+        /**
+         * Allows to access comparator type.
+         * Despite value_compare is defined I prefer
+         * using Compare.
+         */
+        using value_compare = Compare;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using       size_type = typename std::allocator_traits<Allocator>::size_type;
+        using       reference =       value_type &;
+        using const_reference = const value_type &;
+
+        /**
+         * Constructs an empty heap
+         */
+        explicit minmax_heap(
+            const Compare & comparison = Compare(),
+            const Allocator & allocator = Allocator()
+        ) : the_members(comparison, fast_vector<T, Allocator>(allocator)) {}
+
+        /**
+         * Returns the count of elements
+         */
+        size_type size() const noexcept {
+            return storage().size();
+        }
+
+        /**
+         * Returns true if size is 0
+         */
+        bool empty() const noexcept {
+            return storage().empty();
+        }
+
+        /**
+         * Returns a copy of the comparator
+         */
+        Compare value_comp() const {
+            return the_members.first();
+        }
+
+        /**
+         * Returns the smallest element
+         *
+         *   Time Complexity: O(1)
+         * Memory Complexity: O(1)
+         */
+        const_reference min() const {
+            return storage()[0];
+        }
+
+        /**
+         * Returns the greatest element
+         *
+         *   Time Complexity: O(1)
+         * Memory Complexity: O(1)
+         */
+        const_reference max() const {
+            return storage()[max_index()];
+        }
+
+        /**
+         * Adds element to the heap
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1) amortized
+         */
+        void push(const T & item) {
+            storage().push_back(item);
+            bubble_up(size() - 1);
+        }
+
+        /**
+         * Removes the smallest element
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1)
+         */
+        void pop_min() {
+            remove(0);
+        }
+
+        /**
+         * Removes the greatest element
+         *
+         *   Time Complexity: O(log_2(n))
+         * Memory Complexity: O(1)
+         */
+        void pop_max() {
+            remove(max_index());
+        }
+
+    private:
+        /**
+         * The comparator goes first so that
+         * a stateless one takes no space
+         */
+        compressed_pair<Compare, fast_vector<T, Allocator>> the_members;
+
+        /**
+         * Returns the inner storage
+         */
+        fast_vector<T, Allocator> & storage() noexcept {
+            return the_members.second();
+        }
+
+        /**
+         * Returns the inner storage
+         */
+        const fast_vector<T, Allocator> & storage() const noexcept {
+            return the_members.second();
+        }
+
+        /**
+         * Returns true if the element at first
+         * is less than the element at second
+         */
+        bool less(size_type first, size_type second) const {
+            return the_members.first()(storage()[first], storage()[second]);
+        }
+
+        /**
+         * Returns true if the node lies on
+         * a level of minimums
+         */
+        static bool is_min_level(size_type index) noexcept {
+            return bit_width(index + 1) % 2 == 1;
+        }
+
+        /**
+         * Returns the index of the greatest element
+         */
+        size_type max_index() const {
+            if (size() <= 2)
+                return size() - 1;
+
+            return less(1, 2) ? 2 : 1;
+        }
+
+        /**
+         * Replaces the element at the index
+         * with the last one and restores the order
+         */
+        void remove(size_type index) {
+            size_type last = size() - 1;
+
+            if (index != last) {
+                storage()[index] = std::move(storage()[last]);
+                storage().pop_back();
+                trickle_down(index);
+            } else {
+                storage().pop_back();
+            }
+        }
+
+        /**
+         * Moves the element at the index up
+         * through the levels of its kind
+         */
+        void bubble_up(size_type index) {
+            if (index == 0)
+                return;
+
+            size_type parent = (index - 1) / 2;
+
+            if (is_min_level(index)) {
+                if (less(parent, index)) {
+                    std::swap(storage()[index], storage()[parent]);
+                    bubble_up_by(parent, false);
+                } else {
+                    bubble_up_by(index, true);
+                }
+            } else {
+                if (less(index, parent)) {
+                    std::swap(storage()[index], storage()[parent]);
+                    bubble_up_by(parent, true);
+                } else {
+                    bubble_up_by(index, false);
+                }
+            }
+        }
+
+        /**
+         * Moves the element at the index up
+         * jumping over one level at a time.
+         * Goes towards the root while the element
+         * is less (minimums) or greater (maximums)
+         * than its grandparent
+         */
+        void bubble_up_by(size_type index, bool minimums) {
+            while (index > 2) {
+                size_type grandparent = ((index - 1) / 2 - 1) / 2;
+                bool must_swap = minimums ? less(index, grandparent) : less(grandparent, index);
+
+                if (!must_swap)
+                    break;
+
+                std::swap(storage()[index], storage()[grandparent]);
+                index = grandparent;
+            }
+        }
+
+        /**
+         * Moves the element at the index down
+         * through the levels of its kind
+         */
+        void trickle_down(size_type index) {
+            bool minimums = is_min_level(index);
+            size_type count = size();
+
+            while (2 * index + 1 < count) {
+                // the best among children and grandchildren
+                size_type best = 2 * index + 1;
+                size_type candidates[] = {
+                    2 * index + 2,
+                    4 * index + 3, 4 * index + 4,
+                    4 * index + 5, 4 * index + 6,
+                };
+
+                for (size_type it : candidates) {
+                    if (it < count && (minimums ? less(it, best) : less(best, it))) {
+                        best = it;
+                    }
+                }
+
+                bool must_swap = minimums ? less(best, index) : less(index, best);
+
+                if (!must_swap)
+                    break;
+
+                std::swap(storage()[best], storage()[index]);
+
+                // the chosen child beats all its descendants,
+                // so the swapped element fits there
+                if (best <= 2 * index + 2)
+                    break;
+
+                size_type parent = (best - 1) / 2;
+                bool must_fix = minimums ? less(parent, best) : less(best, parent);
+
+                if (must_fix) {
+                    std::swap(storage()[best], storage()[parent]);
+                }
+
+                index = best;
+            }
+        }
+    };
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <algorithm>
+
+
+#include "minmax_heap.h"
+
+
+TEST(minmax_heap_tests, create_empty) {
+    my::minmax_heap<int> heap;
+    ASSERT_EQ(heap.size(), 0);
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(minmax_heap_tests, min_and_max) {
+    auto numbers = std::initializer_list { 10, 14, 5, 3, 72, 156, -41, -6 };
+    my::minmax_heap<int> heap;
+
+    for (auto it = numbers.begin(); it != numbers.end(); it++) {
+        heap.push(*it);
+    }
+
+    ASSERT_EQ(heap.size(), numbers.size());
+    ASSERT_EQ(heap.min(), -41);
+    ASSERT_EQ(heap.max(), 156);
+
+    heap.pop_min();
+    heap.pop_max();
+
+    ASSERT_EQ(heap.min(), -6);
+    ASSERT_EQ(heap.max(), 72);
+}
+
+
+TEST(minmax_heap_tests, random_operations) {
+    my::minmax_heap<int> heap;
+    my::fast_vector<int> reference;
+
+    for (int it = 0; it < 5000; it++) {
+        auto action = rand() % 4;
+
+        if (action == 0 && !heap.empty()) {
+            auto smallest = std::min_element(reference.begin(), reference.end());
+            ASSERT_EQ(heap.min(), *smallest);
+            reference.erase(smallest);
+            heap.pop_min();
+        } else if (action == 1 && !heap.empty()) {
+            auto greatest = std::max_element(reference.begin(), reference.end());
+            ASSERT_EQ(heap.max(), *greatest);
+            reference.erase(greatest);
+            heap.pop_max();
+        } else {
+            auto number = rand() % 1000;
+            reference.push_back(number);
+            heap.push(number);
+        }
+
+        ASSERT_EQ(heap.size(), reference.size());
+
+        if (!heap.empty()) {
+            ASSERT_EQ(heap.min(), *std::min_element(reference.begin(), reference.end()));
+            ASSERT_EQ(heap.max(), *std::max_element(reference.begin(), reference.end()));
+        }
+    }
+}
+
+
+TEST(minmax_heap_tests, custom_compare) {
+    my::minmax_heap<int, std::greater<int>> heap;
+
+    for (int it = 0; it < 100; it++) {
+        heap.push(it);
+    }
+
+    ASSERT_EQ(heap.min(), 99);
+    ASSERT_EQ(heap.max(), 0);
+}
+
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
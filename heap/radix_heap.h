@@ -0,0 +1,253 @@
+#pragma once
+
+// for std::pair
+#include <utility>
+// for std::forward_as_tuple
+#include <tuple>
+// for std::numeric_limits
+#include <limits>
+// for std::out_of_range
+#include <stdexcept>
+// for uint32_t & uint64_t
+#include <cstdint>
+// for std::memcpy
+#include <cstring>
+// for std::is_unsigned
+#include <type_traits>
+// for assert
+#include <cassert>
+// for std::vector
+#include <vector>
+
+// for bit_width
+#include "../auxiliary/algorithm.h"
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Maps keys of a radix_heap to unsigned
+     * integers preserving their order
+     */
+    template <typename Key, typename = void>
+    struct radix_key_traits;
+
+    /**
+     * Unsigned integers are used as is
+     */
+    template <typename Key>
+    struct radix_key_traits<Key, typename std::enable_if<std::is_unsigned<Key>::value>::type> {
+        using bits_type = Key;
+
+        static bits_type encode(Key key) noexcept {
+            return key;
+        }
+    };
+
+    /**
+     * IEEE floats are reinterpreted as unsigned
+     * integers: the sign bit is set for positive
+     * numbers and all bits are flipped for negative
+     * ones so that the integer order matches
+     */
+    template <typename Key>
+    struct radix_key_traits<Key, typename std::enable_if<std::is_floating_point<Key>::value>::type> {
+        using bits_type = typename std::conditional<sizeof(Key) == 4, uint32_t, uint64_t>::type;
+
+        static_assert(
+            std::numeric_limits<Key>::is_iec559 && sizeof(Key) == sizeof(bits_type),
+            "Key must be a 32 or 64 bit IEEE float"
+        );
+
+        static bits_type encode(Key key) noexcept {
+            constexpr bits_type sign = (bits_type) 1 << (sizeof(bits_type) * 8 - 1);
+            bits_type bits;
+            std::memcpy(&bits, &key, sizeof(Key));
+            return (bits & sign) ? ~bits : bits | sign;
+        }
+    };
+
+    /**
+     * Min-heap for monotone keys: a pushed key
+     * must never be less than the last key seen
+     * through top() or pop_top().
+     * Items are spread over buckets by the bit_width
+     * of (key xor last popped key), so popping only
+     * ever redistributes the items of the first
+     * non-empty bucket into the lower ones.
+     * Value may own memory like std::string does,
+     * so the buckets are std::vectors.
+     *
+     *   Time Complexity: O(1) push, O(log C) amortized pop,
+     *                    C = the greatest key difference
+     * Memory Complexity: O(n)
+     */
+    template <typename Key, typename Value>
+    class radix_heap {
+    public:
+        /**
+         * Allows to access template types.
+         * Despite these definitions exist I prefer
+         * using Key and Value.
+         */
+        using    key_type = Key;
+        using mapped_type = Value;
+        using  value_type = std::pair<Key, Value>;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using size_type = size_t;
+
+        /**
+         * Generalizes memory menagement types
+         */
+        using       reference =       value_type &;
+        using const_reference = const value_type &;
+
+        /**
+         * Order preserving mapping of keys
+         */
+        using traits = radix_key_traits<Key>;
+        using bits_type = typename traits::bits_type;
+
+        /**
+         * Bucket 0 keeps keys equal to the last
+         * popped one, bucket i keeps keys whose
+         * highest bit different from it is i - 1
+         */
+        static constexpr size_type bucket_count = sizeof(bits_type) * 8 + 1;
+
+        /**
+         * Returns the count of elements
+         */
+        size_type size() const noexcept {
+            return the_size;
+        }
+
+        /**
+         * Returns true if size is 0
+         */
+        bool empty() const noexcept {
+            return the_size == 0;
+        }
+
+        /**
+         * Returns the smallest key that
+         * may still be pushed. Any key is
+         * accepted until the first top() or pop_top()
+         */
+        Key last_key() const noexcept {
+            return the_last_key;
+        }
+
+        /**
+         * Returns a reference to the
+         * element with the smallest key.
+         * It is const: changing the key would
+         * put it into the wrong bucket.
+         * May reorganize the buckets.
+         * The heap must not be empty
+         */
+        const_reference top() {
+            pull();
+            return the_buckets[0].back();
+        }
+
+        /**
+         * Adds element to the heap.
+         * Throws out_of_range if key is
+         * less than last_key()
+         */
+        void push(const Key & key, const Value & value) {
+            emplace(key, value);
+        }
+
+        /**
+         * Adds element to the heap.
+         * Throws out_of_range if key is
+         * less than last_key()
+         */
+        void push(const value_type & item) {
+            emplace(item.first, item.second);
+        }
+
+        /**
+         * Constructs the value directly in
+         * the bucket of the key
+         */
+        template <typename... K>
+        void emplace(const Key & key, K &&... arguments) {
+            bits_type bits = traits::encode(key);
+
+            if (bits < the_last)
+                throw std::out_of_range("Key is less than the last key");
+
+            the_buckets[bit_width(bits ^ the_last)].emplace_back(
+                std::piecewise_construct,
+                std::forward_as_tuple(key),
+                std::forward_as_tuple(std::forward<K>(arguments)...)
+            );
+            the_size++;
+        }
+
+        /**
+         * Removes the element with
+         * the smallest key.
+         * The heap must not be empty
+         */
+        void pop_top() {
+            pull();
+            the_buckets[0].pop_back();
+            the_size--;
+        }
+
+    private:
+        std::vector<value_type> the_buckets[bucket_count];
+        size_type the_size = 0;
+        bits_type the_last = 0;
+        Key the_last_key = Key();
+
+        /**
+         * Ensures that bucket 0 is not empty by
+         * raising the last key to the minimum
+         * of the first non-empty bucket and
+         * redistributing that bucket
+         */
+        void pull() {
+            assert(the_size != 0 && "The heap must not be empty");
+
+            if (!the_buckets[0].empty())
+                return;
+
+            size_type index = 1;
+
+            while (index < bucket_count - 1 && the_buckets[index].empty()) {
+                index++;
+            }
+
+            if (the_buckets[index].empty())
+                return;
+
+            auto & bucket = the_buckets[index];
+            auto smallest = bucket.begin();
+
+            for (auto it = bucket.begin() + 1; it != bucket.end(); it++) {
+                if (traits::encode(it->first) < traits::encode(smallest->first)) {
+                    smallest = it;
+                }
+            }
+
+            the_last = traits::encode(smallest->first);
+            the_last_key = smallest->first;
+
+            for (auto it = bucket.begin(); it != bucket.end(); it++) {
+                the_buckets[bit_width(traits::encode(it->first) ^ the_last)].emplace_back(std::move(*it));
+            }
+
+            bucket.clear();
+        }
+    };
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+
+#include "radix_heap.h"
+#include "heap.h"
+
+
+TEST(radix_heap_tests, create_empty) {
+    my::radix_heap<unsigned, int> heap;
+    ASSERT_EQ(heap.size(), 0);
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(radix_heap_tests, push_and_pop) {
+    auto numbers = std::initializer_list<unsigned> { 10, 14, 5, 3, 72, 156, 41, 6, 5 };
+    my::radix_heap<unsigned, int> heap;
+
+    for (auto it = numbers.begin(); it != numbers.end(); it++) {
+        heap.push(*it, it - numbers.begin());
+    }
+
+    ASSERT_EQ(heap.size(), numbers.size());
+
+    for (auto expected : { 3, 5, 5, 6, 10, 14, 41, 72, 156 }) {
+        ASSERT_EQ(heap.top().first, expected);
+        heap.pop_top();
+    }
+
+    ASSERT_TRUE(heap.empty());
+}
+
+
+TEST(radix_heap_tests, floats) {
+    auto numbers = std::initializer_list<double> { 1.5, -2.25, 0.0, 100.0, -0.5, 3.75 };
+    my::radix_heap<double, int> heap;
+
+    for (auto it = numbers.begin(); it != numbers.end(); it++) {
+        heap.push(*it, 0);
+    }
+
+    for (auto expected : { -2.25, -0.5, 0.0, 1.5, 3.75, 100.0 }) {
+        ASSERT_EQ(heap.top().first, expected);
+        heap.pop_top();
+    }
+}
+
+
+TEST(radix_heap_tests, monotone) {
+    my::radix_heap<unsigned long long, int> heap;
+
+    heap.push(10, 0);
+    heap.push(20, 0);
+    heap.pop_top();
+
+    ASSERT_EQ(heap.last_key(), 10);
+    ASSERT_THROW(heap.push(5, 0), std::out_of_range);
+
+    heap.push(10, 0);
+    heap.push(15, 0);
+    ASSERT_EQ(heap.top().first, 10);
+}
+
+
+TEST(radix_heap_tests, matches_heap) {
+    my::radix_heap<unsigned, unsigned> radix;
+    my::heap<unsigned, std::greater<unsigned>> reference;
+    unsigned last = 0;
+
+    for (int it = 0; it < 5000; it++) {
+        if (rand() % 3 == 0 && !reference.empty()) {
+            ASSERT_EQ(radix.top().first, reference.top());
+            last = reference.top();
+            radix.pop_top();
+            reference.pop_top();
+        } else {
+            unsigned key = last + rand() % 1000;
+            radix.push(key, it);
+            reference.push(key);
+        }
+
+        ASSERT_EQ(radix.size(), reference.size());
+    }
+}
+
+
+TEST(radix_heap_tests, string_values) {
+    // values that own memory survive redistribution
+    my::radix_heap<uint32_t, std::string> heap;
+
+    for (uint32_t it = 0; it < 1000; it++) {
+        uint32_t key = (it * 7919) % 1000;
+        heap.push(key, "value with a long name " + std::to_string(key));
+    }
+
+    for (uint32_t it = 0; it < 1000; it++) {
+        ASSERT_EQ(heap.top().first, it);
+        ASSERT_EQ(heap.top().second, "value with a long name " + std::to_string(it));
+        heap.pop_top();
+    }
+
+    static_assert(
+        std::is_const<std::remove_reference<decltype(heap.top())>::type>::value,
+        "top() must not allow to change the key"
+    );
+}
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,564 @@
+#pragma once
+
+// for std::function
+#include <functional>
+// for uint64_t & uint32_t
+#include <cstdint>
+// for std::vector
+#include <vector>
+
+#include "../fast_vector/fast_vector.h"
+// for the overflow of far deadlines
+#include "heap.h"
+
+
+/**
+ * Count of wheels. Deadlines further than
+ * 2^(LEVELS * SLOT_BITS) ticks go to the overflow heap
+ */
+#define TIMER_WHEEL_LEVELS 4
+
+/**
+ * Every wheel has 2^SLOT_BITS slots
+ */
+#define TIMER_WHEEL_SLOT_BITS 8
+
+
+/**
+ * Custom implementations
+ */
+namespace my {
+    /**
+     * Counters describing the work
+     * done by a timer_wheel
+     */
+    struct timer_wheel_stats {
+        /**
+         * Count of calls to schedule
+         */
+        size_t scheduled = 0;
+
+        /**
+         * Count of successful cancels
+         */
+        size_t cancelled = 0;
+
+        /**
+         * Count of returned callbacks
+         */
+        size_t expired = 0;
+
+        /**
+         * Count of timers moved
+         * from a wheel to a lower one
+         */
+        size_t cascaded = 0;
+
+        /**
+         * Count of timers moved from
+         * the overflow heap into the wheels
+         */
+        size_t pulled = 0;
+
+        /**
+         * Count of pending timers on every wheel
+         */
+        size_t occupancy[TIMER_WHEEL_LEVELS] = {};
+
+        /**
+         * Count of pending timers
+         * in the overflow heap
+         */
+        size_t overflow = 0;
+    };
+
+    /**
+     * Hierarchical timing wheel. A timer lands on
+     * the wheel of the highest SLOT_BITS-wide digit
+     * in which its deadline differs from the current
+     * time and moves down one wheel at a time as the
+     * time approaches it. Deadlines beyond the top
+     * wheel wait in a my::heap.
+     *
+     * schedule and cancel are O(1) for deadlines that
+     * fit into the wheels (cancelling a far timer is
+     * O(1) amortized too: its heap entry is skipped
+     * when pulled, and the heap is purged of such
+     * entries once they outnumber the live ones).
+     * Timers are kept in a std::vector, so callbacks
+     * such as std::function are moved, never
+     * relocated byte by byte.
+     * advance skips empty slots and returns callbacks
+     * in deadline order, timers with equal deadlines
+     * in the order they were scheduled.
+     * Deadlines in the past fire on the next advance
+     */
+    template <typename Callback = std::function<void ()>>
+    class timer_wheel {
+    public:
+        /**
+         * Generalizes time types
+         */
+        using time_type = uint64_t;
+        using size_type = size_t;
+
+        /**
+         * Identifies a scheduled timer.
+         * Stays unique after the timer fires
+         * or is cancelled
+         */
+        using handle = uint64_t;
+
+        static constexpr size_type levels = TIMER_WHEEL_LEVELS;
+        static constexpr size_type slot_bits = TIMER_WHEEL_SLOT_BITS;
+        static constexpr size_type slot_count = (size_type) 1 << slot_bits;
+
+        /**
+         * Constructs empty wheels
+         * starting at the given time
+         */
+        explicit timer_wheel(time_type now = 0) : the_now(now) {
+            for (size_type level = 0; level < levels; level++) {
+                for (size_type slot = 0; slot < slot_count; slot++) {
+                    the_heads[level][slot] = npos;
+                }
+
+                for (size_type word = 0; word < words; word++) {
+                    the_occupied[level][word] = 0;
+                }
+            }
+        }
+
+        /**
+         * Returns the current time
+         */
+        time_type now() const noexcept {
+            return the_now;
+        }
+
+        /**
+         * Returns the count of pending timers
+         */
+        size_type size() const noexcept {
+            return the_size;
+        }
+
+        /**
+         * Returns true if size is 0
+         */
+        bool empty() const noexcept {
+            return the_size == 0;
+        }
+
+        /**
+         * Returns the counters
+         */
+        const timer_wheel_stats & stats() const noexcept {
+            return the_stats;
+        }
+
+        /**
+         * Registers the callback to fire at the deadline
+         *
+         *   Time Complexity: O(1), O(log n) for far deadlines
+         * Memory Complexity: O(1) amortized
+         */
+        handle schedule(time_type deadline, Callback callback) {
+            uint32_t index = acquire();
+            node & item = the_nodes[index];
+
+            item.deadline = deadline < the_now ? the_now : deadline;
+            item.callback = std::move(callback);
+
+            place(index);
+            the_size++;
+            the_stats.scheduled++;
+
+            return ((handle) item.generation << 32) | index;
+        }
+
+        /**
+         * Removes a pending timer. Returns false if
+         * it has already fired or been cancelled
+         *
+         *   Time Complexity: O(1)
+         * Memory Complexity: O(1)
+         */
+        bool cancel(handle it) {
+            uint32_t index = (uint32_t) it;
+
+            if (index >= the_nodes.size())
+                return false;
+
+            node & item = the_nodes[index];
+
+            if (item.generation != (uint32_t) (it >> 32) || item.level == free_level)
+                return false;
+
+            bool far = item.level == overflow_level;
+
+            if (!far) {
+                unlink(index);
+            }
+
+            release(index);
+            the_size--;
+            the_stats.cancelled++;
+
+            // the heap entry is skipped when pulled
+            if (far) {
+                the_stats.overflow--;
+
+                if (the_overflow.size() > 2 * the_stats.overflow) {
+                    purge();
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Moves the time forward and appends
+         * the callbacks of all timers with
+         * deadline <= now to expired, which may
+         * be any container with push_back
+         *
+         *   Time Complexity: O(k + s), k = count of expired and cascaded timers,
+         *                              s = count of visited non-empty slots
+         * Memory Complexity: O(k)
+         */
+        template <typename Container>
+        void advance(time_type now, Container & expired) {
+            while (true) {
+                expire(expired);
+
+                if (the_now >= now)
+                    break;
+
+                time_type next = next_event();
+                the_now = next < now ? next : now;
+
+                cascade();
+            }
+        }
+
+        /**
+         * Moves the time forward and returns
+         * the callbacks of all timers with
+         * deadline <= now
+         */
+        std::vector<Callback> advance(time_type now) {
+            std::vector<Callback> expired;
+            advance(now, expired);
+            return expired;
+        }
+
+    private:
+        static constexpr uint32_t npos = 0xFFFFFFFF;
+        static constexpr uint8_t overflow_level = levels;
+        static constexpr uint8_t free_level = levels + 1;
+        static constexpr size_type words = slot_count / 64;
+        static constexpr time_type slot_mask = slot_count - 1;
+        static constexpr size_type wheel_bits = levels * slot_bits;
+
+        static_assert(slot_count >= 64, "SLOT_BITS must be at least 6");
+        static_assert(wheel_bits < 64, "Wheels must not cover the whole time range");
+
+        /**
+         * Timer storage. Timers of a slot form
+         * a circular doubly-linked list of indices
+         */
+        struct node {
+            time_type deadline = 0;
+            Callback callback;
+            uint32_t next = npos;
+            uint32_t prev = npos;
+            uint32_t generation = 0;
+            uint8_t level = free_level;
+            uint32_t slot = 0;
+        };
+
+        /**
+         * Overflow entry: deadline, schedule
+         * sequence, generation and index of the node.
+         * The sequence keeps equal deadlines
+         * in the order they were scheduled
+         */
+        struct far_timer {
+            time_type deadline;
+            uint64_t sequence;
+            uint32_t generation;
+            uint32_t index;
+
+            bool operator > (const far_timer & other) const {
+                if (deadline != other.deadline)
+                    return deadline > other.deadline;
+
+                return sequence > other.sequence;
+            }
+        };
+
+        time_type the_now;
+        size_type the_size = 0;
+        uint64_t the_sequence = 0;
+        std::vector<node> the_nodes;
+        fast_vector<uint32_t> the_free;
+        uint32_t the_heads[levels][slot_count];
+        uint64_t the_occupied[levels][words];
+        heap<far_timer, greater<far_timer>> the_overflow;
+        timer_wheel_stats the_stats;
+
+        /**
+         * Returns the index of a free node
+         */
+        uint32_t acquire() {
+            if (the_free.empty()) {
+                the_nodes.emplace_back();
+                return the_nodes.size() - 1;
+            }
+
+            uint32_t index = the_free.back();
+            the_free.pop_back();
+            return index;
+        }
+
+        /**
+         * Marks the node as free and
+         * invalidates its handles
+         */
+        void release(uint32_t index) {
+            node & item = the_nodes[index];
+            item.level = free_level;
+            item.generation++;
+            item.callback = Callback();
+            the_free.push_back(index);
+        }
+
+        /**
+         * Rebuilds the overflow heap
+         * without the cancelled timers
+         *
+         *   Time Complexity: O(n)
+         * Memory Complexity: O(n)
+         */
+        void purge() {
+            fast_vector<far_timer> live;
+
+            for (auto & far : the_overflow) {
+                node & item = the_nodes[far.index];
+
+                if (item.generation == far.generation && item.level == overflow_level) {
+                    live.push_back(far);
+                }
+            }
+
+            the_overflow = heap<far_timer, greater<far_timer>>(live.begin(), live.end());
+        }
+
+        /**
+         * Puts the node onto the wheel of the highest
+         * digit where its deadline differs from now,
+         * or into the overflow heap
+         */
+        void place(uint32_t index) {
+            node & item = the_nodes[index];
+            time_type difference = item.deadline ^ the_now;
+
+            for (size_type level = 0; level < levels; level++) {
+                if ((difference >> ((level + 1) * slot_bits)) == 0) {
+                    link(index, level, (item.deadline >> (level * slot_bits)) & slot_mask);
+                    return;
+                }
+            }
+
+            item.level = overflow_level;
+            the_overflow.push(far_timer { item.deadline, the_sequence++, item.generation, index });
+            the_stats.overflow++;
+        }
+
+        /**
+         * Appends the node to the slot
+         */
+        void link(uint32_t index, size_type level, size_type slot) {
+            node & item = the_nodes[index];
+            uint32_t & head = the_heads[level][slot];
+
+            item.level = level;
+            item.slot = slot;
+
+            if (head == npos) {
+                head = index;
+                item.next = index;
+                item.prev = index;
+                the_occupied[level][slot / 64] |= (uint64_t) 1 << (slot % 64);
+            } else {
+                uint32_t tail = the_nodes[head].prev;
+                item.next = head;
+                item.prev = tail;
+                the_nodes[tail].next = index;
+                the_nodes[head].prev = index;
+            }
+
+            the_stats.occupancy[level]++;
+        }
+
+        /**
+         * Removes the node from its slot
+         */
+        void unlink(uint32_t index) {
+            node & item = the_nodes[index];
+            uint32_t & head = the_heads[item.level][item.slot];
+
+            if (item.next == index) {
+                head = npos;
+                the_occupied[item.level][item.slot / 64] &= ~((uint64_t) 1 << (item.slot % 64));
+            } else {
+                the_nodes[item.prev].next = item.next;
+                the_nodes[item.next].prev = item.prev;
+
+                if (head == index) {
+                    head = item.next;
+                }
+            }
+
+            the_stats.occupancy[item.level]--;
+        }
+
+        /**
+         * Detaches the whole slot and
+         * returns the index of its first node
+         */
+        uint32_t detach(size_type level, size_type slot) {
+            uint32_t head = the_heads[level][slot];
+
+            if (head != npos) {
+                the_heads[level][slot] = npos;
+                the_occupied[level][slot / 64] &= ~((uint64_t) 1 << (slot % 64));
+            }
+
+            return head;
+        }
+
+        /**
+         * Fires all timers of the current slot
+         * of the lowest wheel: their deadline is now
+         */
+        template <typename Container>
+        void expire(Container & expired) {
+            uint32_t head = detach(0, the_now & slot_mask);
+
+            if (head == npos)
+                return;
+
+            uint32_t it = head;
+
+            do {
+                uint32_t next = the_nodes[it].next;
+                expired.push_back(std::move(the_nodes[it].callback));
+                release(it);
+                the_size--;
+                the_stats.occupancy[0]--;
+                the_stats.expired++;
+                it = next;
+            } while (it != head);
+        }
+
+        /**
+         * Moves timers that became near down:
+         * first pulls from the overflow heap at the boundary
+         * of the top wheel, then cascades every wheel whose
+         * lower digits of now are all zero
+         */
+        void cascade() {
+            if ((the_now & (((time_type) 1 << wheel_bits) - 1)) == 0) {
+                while (!the_overflow.empty() && (the_overflow.top().deadline >> wheel_bits) == (the_now >> wheel_bits)) {
+                    far_timer far = the_overflow.top();
+                    the_overflow.pop_top();
+
+                    node & item = the_nodes[far.index];
+
+                    if (item.generation != far.generation || item.level != overflow_level)
+                        continue;
+
+                    the_stats.overflow--;
+                    the_stats.pulled++;
+                    place(far.index);
+                }
+            }
+
+            for (size_type level = levels - 1; level > 0; level--) {
+                if ((the_now & (((time_type) 1 << (level * slot_bits)) - 1)) != 0)
+                    continue;
+
+                uint32_t head = detach(level, (the_now >> (level * slot_bits)) & slot_mask);
+
+                if (head == npos)
+                    continue;
+
+                uint32_t it = head;
+
+                do {
+                    uint32_t next = the_nodes[it].next;
+                    the_stats.occupancy[level]--;
+                    the_stats.cascaded++;
+                    place(it);
+                    it = next;
+                } while (it != head);
+            }
+        }
+
+        /**
+         * Returns the index of the first occupied slot
+         * of the wheel after the given one or slot_count
+         */
+        size_type next_occupied(size_type level, size_type slot) const {
+            slot++;
+
+            while (slot < slot_count) {
+                uint64_t word = the_occupied[level][slot / 64] >> (slot % 64);
+
+                if (word != 0) {
+#if defined(__GNUC__) || defined(__clang__)
+                    return slot + __builtin_ctzll(word);
+#else
+                    while ((word & 1) == 0) {
+                        word >>= 1;
+                        slot++;
+                    }
+
+                    return slot;
+#endif
+                }
+
+                slot = (slot / 64 + 1) * 64;
+            }
+
+            return slot_count;
+        }
+
+        /**
+         * Returns the nearest time at which
+         * some slot must be expired or cascaded
+         */
+        time_type next_event() const {
+            for (size_type level = 0; level < levels; level++) {
+                size_type shift = level * slot_bits;
+                size_type slot = next_occupied(level, (the_now >> shift) & slot_mask);
+
+                if (slot != slot_count) {
+                    time_type block = (the_now >> (shift + slot_bits)) << (shift + slot_bits);
+                    return block | ((time_type) slot << shift);
+                }
+            }
+
+            // the wheels are empty
+            if (the_overflow.empty())
+                return ~(time_type) 0;
+
+            time_type far = (the_overflow.top().deadline >> wheel_bits) << wheel_bits;
+            time_type wrap = ((the_now >> wheel_bits) + 1) << wheel_bits;
+
+            return far > wrap ? far : wrap;
+        }
+    };
+}
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <random>
+#include <chrono>
+
+
+#include "timer_wheel.h"
+#include "indexed_heap.h"
+
+
+TEST(timer_wheel_tests, create_empty) {
+    my::timer_wheel<> wheel;
+    ASSERT_EQ(wheel.size(), 0);
+    ASSERT_TRUE(wheel.advance(1000).empty());
+    ASSERT_EQ(wheel.now(), 1000);
+}
+
+
+TEST(timer_wheel_tests, fires_in_deadline_order) {
+    my::timer_wheel<int> wheel;
+    auto deadlines = std::initializer_list<uint64_t> { 300, 5, 70000, 5, 1ull << 40, 256, 255, 20000000 };
+    int id = 0;
+
+    for (auto deadline : deadlines) {
+        wheel.schedule(deadline, id++);
+    }
+
+    auto fired = wheel.advance(1000);
+    my::fast_vector<int> expected = { 1, 3, 6, 5, 0 };
+
+    ASSERT_EQ(fired.size(), expected.size());
+    ASSERT_TRUE(std::equal(fired.begin(), fired.end(), expected.begin()));
+
+    fired = wheel.advance(1ull << 41);
+    expected = { 2, 7, 4 };
+
+    ASSERT_EQ(fired.size(), expected.size());
+    ASSERT_TRUE(std::equal(fired.begin(), fired.end(), expected.begin()));
+    ASSERT_TRUE(wheel.empty());
+    ASSERT_GT(wheel.stats().cascaded, 0);
+    ASSERT_EQ(wheel.stats().pulled, 1);
+}
+
+
+TEST(timer_wheel_tests, cancel) {
+    my::timer_wheel<int> wheel;
+
+    auto near = wheel.schedule(10, 1);
+    auto far  = wheel.schedule(1ull << 40, 2);
+    wheel.schedule(20, 3);
+
+    ASSERT_EQ(wheel.stats().occupancy[0], 2);
+    ASSERT_EQ(wheel.stats().overflow, 1);
+
+    ASSERT_TRUE(wheel.cancel(near));
+    ASSERT_TRUE(wheel.cancel(far));
+    ASSERT_FALSE(wheel.cancel(near));
+    ASSERT_EQ(wheel.size(), 1);
+
+    auto fired = wheel.advance(1ull << 41);
+    ASSERT_EQ(fired.size(), 1);
+    ASSERT_EQ(fired[0], 3);
+    ASSERT_EQ(wheel.stats().cancelled, 2);
+    ASSERT_EQ(wheel.stats().overflow, 0);
+}
+
+
+TEST(timer_wheel_tests, cancelled_far_timers_are_purged) {
+    my::timer_wheel<int> wheel;
+    my::fast_vector<my::timer_wheel<int>::handle> handles;
+
+    for (int it = 0; it < 1000; it++) {
+        handles.push_back(wheel.schedule((1ull << 40) + it, it));
+    }
+
+    for (int it = 0; it < 990; it++) {
+        ASSERT_TRUE(wheel.cancel(handles[it]));
+    }
+
+    ASSERT_EQ(wheel.stats().overflow, 10);
+    ASSERT_TRUE(wheel.advance(1ull << 40).empty());
+
+    auto fired = wheel.advance((1ull << 40) + 1000);
+    ASSERT_EQ(fired.size(), 10);
+    ASSERT_EQ(fired.front(), 990);
+    ASSERT_EQ(wheel.stats().pulled, 10);
+}
+
+
+TEST(timer_wheel_tests, far_timers_keep_schedule_order) {
+    my::timer_wheel<int> wheel;
+    my::fast_vector<my::timer_wheel<int>::handle> handles;
+
+    // equal far deadlines interleaved with
+    // others, then cut by a purge of the heap
+    for (int it = 0; it < 60; it++) {
+        uint64_t deadline = it % 3 == 0 ? (1ull << 33) + 5 : (1ull << 33) + 100 + it;
+        handles.push_back(wheel.schedule(deadline, it));
+    }
+
+    for (int it = 0; it < 60; it++) {
+        if (it % 3 != 0) {
+            ASSERT_TRUE(wheel.cancel(handles[it]));
+        }
+    }
+
+    ASSERT_EQ(wheel.stats().overflow, 20);
+
+    auto fired = wheel.advance((1ull << 33) + 5);
+    ASSERT_EQ(fired.size(), 20);
+
+    for (size_t it = 0; it < fired.size(); it++) {
+        ASSERT_EQ(fired[it], 3 * (int) it);
+    }
+}
+
+TEST(timer_wheel_tests, function_callbacks) {
+    my::timer_wheel<> wheel;
+    std::string log;
+
+    // enough timers to grow the storage
+    // while callbacks own captured strings
+    for (int it = 0; it < 100; it++) {
+        std::string name = "timer " + std::to_string(it) + " with a long name;";
+        wheel.schedule(it % 10, [&log, name] { log += name; });
+    }
+
+    for (auto & callback : wheel.advance(100)) {
+        callback();
+    }
+
+    ASSERT_EQ(log.size(), 100 * std::string("timer 00 with a long name;").size() - 10);
+}
+
+
+TEST(timer_wheel_tests, matches_sorting) {
+    my::timer_wheel<uint64_t> wheel(12345);
+    my::fast_vector<uint64_t> deadlines;
+    my::fast_vector<uint64_t> fired;
+
+    for (int it = 0; it < 3000; it++) {
+        uint64_t deadline = wheel.now() + ((uint64_t) rand() << (rand() % 16));
+        deadlines.push_back(deadline);
+        wheel.schedule(deadline, deadline);
+
+        if (it % 10 == 0) {
+            wheel.advance(wheel.now() + rand() % 5000, fired);
+        }
+    }
+
+    wheel.advance(~(uint64_t) 0 >> 1, fired);
+
+    ASSERT_TRUE(wheel.empty());
+    ASSERT_EQ(fired.size(), deadlines.size());
+    std::sort(deadlines.begin(), deadlines.end());
+
+    for (size_t it = 0; it < fired.size(); it++) {
+        ASSERT_EQ(fired[it], deadlines[it]);
+    }
+}
+
+
+TEST(timer_wheel_tests, fires_late_timers_immediately) {
+    my::timer_wheel<int> wheel(100);
+
+    wheel.schedule(50, 1);
+    auto fired = wheel.advance(100);
+
+    ASSERT_EQ(fired.size(), 1);
+    ASSERT_EQ(fired[0], 1);
+}
+
+
+TEST(timer_wheel_tests, DISABLED_cancel_benchmark) {
+    // network timeouts: 90% of the timers are cancelled
+    // 500 ticks after being scheduled, 100 timers a tick
+    const size_t count = 2000000;
+    const size_t per_tick = 100;
+    const size_t delay = 500 * per_tick;
+
+    std::mt19937 generator(42);
+    my::fast_vector<uint64_t> timeouts;
+
+    for (size_t it = 0; it < count; it++) {
+        timeouts.push_back(1000 + generator() % 60000);
+    }
+
+    auto measure = [&](auto schedule, auto cancel, auto advance) {
+        size_t fired = 0;
+        uint64_t now = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t it = 0; it < count; it++) {
+            schedule(it, now + timeouts[it]);
+
+            if (it >= delay && (it - delay) % 10 != 0) {
+                cancel(it - delay);
+            }
+
+            if (it % per_tick == per_tick - 1) {
+                fired += advance(++now);
+            }
+        }
+
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << elapsed.count() / count << " ns per timer, " << fired << " fired" << std::endl;
+    };
+
+    my::timer_wheel<size_t> wheel;
+    my::fast_vector<my::timer_wheel<size_t>::handle> handles(count, 0);
+    my::fast_vector<size_t> expired;
+
+    std::cout << "timer_wheel: ";
+    measure(
+        [&](size_t it, uint64_t deadline) { handles[it] = wheel.schedule(deadline, it); },
+        [&](size_t it) { wheel.cancel(handles[it]); },
+        [&](uint64_t now) {
+            expired.clear();
+            wheel.advance(now, expired);
+            return expired.size();
+        }
+    );
+
+    my::indexed_heap<size_t, uint64_t, std::greater<uint64_t>> heap;
+    my::fast_vector<size_t> keys(count, 0);
+
+    std::cout << "indexed_heap: ";
+    measure(
+        [&](size_t it, uint64_t deadline) { keys[it] = heap.push(it, deadline); },
+        [&](size_t it) { heap.erase(keys[it]); },
+        [&](uint64_t now) {
+            size_t fired = 0;
+
+            for (; !heap.empty() && heap.top_priority() <= now; fired++) {
+                heap.pop_top();
+            }
+
+            return fired;
+        }
+    );
+}
+
+int main(int argc, char * argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}